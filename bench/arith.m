@@ -0,0 +1,14 @@
+# Arithmetic in a counted loop: 3M iterations of swap/push/mul/add/mod
+push 0
+push 3000000
+label l
+swap
+push 3
+mul
+push 7
+add
+push 1000
+mod
+swap
+loop l
+pint
@@ -0,0 +1,209 @@
+/*
+ * bench_monty.c - Benchmark runner for the Monty interpreter.
+ *
+ *	bench_monty [-r runs] [-o results.json] [-c baseline.json]
+ *		[-t percent] [-f floor_ms] monty workload...
+ *
+ * Runs every workload (a .m script, or a .bf program run with --bf)
+ * through the given interpreter a number of times, with stdin, stdout
+ * and stderr on /dev/null, and writes the median and p99 wall time and
+ * the peak resident set size of each to a JSON file. With -c the medians
+ * are compared to an earlier results file and the runner fails if any
+ * workload got slower by more than the threshold; workloads whose
+ * baseline median is under the floor are reported but never fail the
+ * gate, as process start-up noise dominates them.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+
+double bench_once(char *monty, char *workload, long *rss);
+int cmp_double(const void *a, const void *b);
+double bench_baseline(char *path, char *workload);
+int bench_check(char *workload, double median, long rss, double base,
+		double pct, double floor_ms);
+int main(int argc, char **argv);
+
+/**
+ * bench_once - Runs a workload once.
+ * @monty: Path of the interpreter.
+ * @workload: Path of the workload.
+ * @rss: Raised to the peak resident set size of the run, in KB.
+ *
+ * Return: The wall time in milliseconds, or -1 if it could not be run.
+ */
+double bench_once(char *monty, char *workload, long *rss)
+{
+	struct timespec t0, t1;
+	struct rusage ru;
+	size_t len = strlen(workload);
+	int bf = len > 3 && strcmp(workload + len - 3, ".bf") == 0;
+	pid_t pid;
+	int fd, status;
+
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	pid = fork();
+	if (pid == 0)
+	{
+		fd = open("/dev/null", O_RDWR);
+		dup2(fd, STDIN_FILENO);
+		dup2(fd, STDOUT_FILENO);
+		dup2(fd, STDERR_FILENO);
+		if (bf)
+			execl(monty, monty, "--bf", workload, (char *)NULL);
+		else
+			execl(monty, monty, workload, (char *)NULL);
+		_exit(127);
+	}
+	if (pid == -1 || wait4(pid, &status, 0, &ru) == -1 ||
+	    (WIFEXITED(status) && WEXITSTATUS(status) == 127))
+		return (-1);
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+	if (ru.ru_maxrss > *rss)
+		*rss = ru.ru_maxrss;
+	return ((t1.tv_sec - t0.tv_sec) * 1e3 +
+		(t1.tv_nsec - t0.tv_nsec) / 1e6);
+}
+
+/**
+ * cmp_double - qsort comparator for doubles.
+ * @a: Pointer to the first double.
+ * @b: Pointer to the second double.
+ *
+ * Return: Negative, zero or positive as *a is below, equal to or above *b.
+ */
+int cmp_double(const void *a, const void *b)
+{
+	double x = *(const double *)a, y = *(const double *)b;
+
+	return ((x > y) - (x < y));
+}
+
+/**
+ * bench_baseline - Finds the median of a workload in a results file.
+ * @path: The results file, as written by this runner.
+ * @workload: The workload.
+ *
+ * Return: The median in milliseconds, or -1 if the workload is not there.
+ */
+double bench_baseline(char *path, char *workload)
+{
+	char line[4096], name[4096];
+	double median, p99;
+	FILE *f = fopen(path, "r");
+
+	if (f == NULL)
+		return (-1);
+	while (fgets(line, sizeof(line), f) != NULL)
+	{
+		if (sscanf(line, " {\"name\": \"%4095[^\"]\", "
+			   "\"median_ms\": %lf, \"p99_ms\": %lf",
+			   name, &median, &p99) == 3 &&
+		    strcmp(name, workload) == 0)
+		{
+			fclose(f);
+			return (median);
+		}
+	}
+	fclose(f);
+	return (-1);
+}
+
+/**
+ * bench_check - Compares the median of a workload with its baseline.
+ * @workload: The workload.
+ * @median: Its median now, in milliseconds.
+ * @rss: Its peak resident set size, in KB.
+ * @base: Its baseline median, or -1 if it has none.
+ * @pct: Allowed slowdown, in percent.
+ * @floor_ms: Baseline medians under this never fail the gate.
+ *
+ * Return: 1 if the workload regressed, 0 otherwise.
+ */
+int bench_check(char *workload, double median, long rss, double base,
+		double pct, double floor_ms)
+{
+	int regressed;
+
+	if (base <= 0)
+	{
+		fprintf(stderr, "%-40s %10.3f ms %8ld KB   (no baseline)\n",
+			workload, median, rss);
+		return (0);
+	}
+	regressed = median > base * (1 + pct / 100) && base >= floor_ms;
+	fprintf(stderr, "%-40s %10.3f ms %8ld KB  %+7.1f%%%s\n", workload,
+		median, rss, (median / base - 1) * 100,
+		regressed ? "  REGRESSION" :
+		base < floor_ms ? "  (below floor)" : "");
+	return (regressed);
+}
+
+/**
+ * main - Runs the benchmarks.
+ * @argc: Number of command-line arguments.
+ * @argv: Array of command-line argument strings.
+ *
+ * Return: 0, or 1 on error or if a workload regressed.
+ */
+int main(int argc, char **argv)
+{
+	char *out = "bench/results.json", *base = NULL;
+	double pct = 10, floor_ms = 20, *t;
+	int runs = 11, c, i, w, p99, bad = 0;
+	long rss;
+	FILE *f;
+
+	while ((c = getopt(argc, argv, "r:o:c:t:f:")) != -1)
+	{
+		if (c == 'r')
+			runs = atoi(optarg);
+		else if (c == 'o')
+			out = optarg;
+		else if (c == 'c')
+			base = optarg;
+		else if (c == 't')
+			pct = atof(optarg);
+		else if (c == 'f')
+			floor_ms = atof(optarg);
+		else
+			return (1);
+	}
+	t = malloc(sizeof(double) * (runs > 0 ? runs : 1));
+	f = argc - optind >= 2 && runs > 0 && t ? fopen(out, "w") : NULL;
+	if (f == NULL)
+	{
+		fprintf(stderr, "USAGE: bench_monty [-r runs] "
+			"[-o results.json] [-c baseline.json] [-t percent] "
+			"[-f floor_ms] monty workload...\n");
+		return (1);
+	}
+	fprintf(f, "{\n\"runs\": %d,\n\"workloads\": [\n", runs);
+	for (w = optind + 1; w < argc; w++)
+	{
+		rss = 0;
+		for (i = 0; i < runs; i++)
+		{
+			t[i] = bench_once(argv[optind], argv[w], &rss);
+			if (t[i] < 0)
+				return (1);
+		}
+		qsort(t, runs, sizeof(double), cmp_double);
+		p99 = (runs * 99 + 99) / 100 - 1; /* nearest rank */
+		fprintf(f, " {\"name\": \"%s\", \"median_ms\": %.3f, "
+			"\"p99_ms\": %.3f, \"max_rss_kb\": %ld}%s\n", argv[w],
+			t[runs / 2], t[p99], rss, w + 1 < argc ? "," : "");
+		bad += bench_check(argv[w], t[runs / 2], rss,
+				   base ? bench_baseline(base, argv[w]) : -1,
+				   pct, floor_ms);
+	}
+	fprintf(f, "]\n}\n");
+	fclose(f);
+	free(t);
+	return (bad != 0);
+}
@@ -0,0 +1,17 @@
+# Subroutine calls: the arith.m loop body behind call/ret, 3M calls
+def step
+push 3
+mul
+push 7
+add
+push 1000
+mod
+end
+push 0
+push 3000000
+label l
+swap
+call step
+swap
+loop l
+pint
@@ -0,0 +1,17 @@
+# Deep stack: 10M values pushed by a counted loop, then popped again
+select 1
+push 10000000
+label fill
+select 0
+push 7
+select 1
+loop fill
+select 0
+pint
+select 1
+push 10000000
+label drain
+select 0
+pop
+select 1
+loop drain
@@ -0,0 +1,22 @@
+# FIFO traffic: 2M enqueue/dequeue pairs on a queue holding 1000 values
+select 1
+push 1000
+label fill
+select 0
+push 1
+select 1
+loop fill
+select 0
+queue
+select 1
+push 2000000
+label q
+select 0
+push 2
+pop
+movto 2
+movfrom 2
+select 1
+loop q
+select 0
+pint
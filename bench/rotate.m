@@ -0,0 +1,18 @@
+# Rotations of a 50k-element stack; the counter lives on stack 1
+push 50000
+label fill
+push 7
+swap
+loop fill
+pop
+select 1
+push 2000000
+label r
+select 0
+rotl
+rotr
+rotl
+select 1
+loop r
+select 0
+pint
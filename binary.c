@@ -0,0 +1,189 @@
+#include "monty.h"
+#include <string.h>
+#include <sys/uio.h>
+
+/* LE32 - A little-endian int32 from the file as a host int, or back */
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define LE32(x) ((int)__builtin_bswap32((uint32_t)(x)))
+#define LE_HOST 0
+#else
+#define LE32(x) (x)
+#define LE_HOST 1
+#endif
+
+int stack_load(stack_t *stack, const int *vals, size_t n);
+int stack_save(stack_t *stack, int fd);
+int save_ring(stack_t *stack, int fd, int rev);
+int save_spill(stack_t *stack, int fd, int rev);
+
+/**
+ * stack_load - Pushes the values of a load file, first to last.
+ * @stack: The stack_t.
+ * @vals: The little-endian values.
+ * @n: Number of values.
+ *
+ * Description: The ring buffer grows once. In queue mode the values land
+ * at the bottom in file order, so they are copied with at most two
+ * memcpy; in stack mode the last one ends up on top, so they are copied
+ * backwards. With --max-depth or --spill each value goes through
+ * stack_push instead.
+ *
+ * Return: EXIT_SUCCESS, or the failure of stack_push or stack_grow.
+ */
+int stack_load(stack_t *stack, const int *vals, size_t n)
+{
+	size_t i, start, first;
+	int status;
+
+	if (opts.max_depth || opts.spill)
+	{
+		for (i = 0, status = EXIT_SUCCESS; i < n && !status; i++)
+			status = stack_push(stack, LE32(vals[i]));
+		return (status);
+	}
+	while (stack->cap - stack->len < n)
+	{
+		status = stack_grow(stack);
+		if (status != EXIT_SUCCESS)
+			return (status);
+	}
+	if (stack->mode == QUEUE && LE_HOST)
+	{
+		start = (stack->head + stack->len) & (stack->cap - 1);
+		first = stack->cap - start < n ? stack->cap - start : n;
+		memcpy(stack->vals + start, vals, sizeof(int) * first);
+		memcpy(stack->vals, vals + first, sizeof(int) * (n - first));
+	}
+	else if (stack->mode == QUEUE)
+		for (i = 0; i < n; i++)
+			STACK_AT(stack, stack->len + i) = LE32(vals[i]);
+	else
+	{
+		stack->head = (stack->head - n) & (stack->cap - 1);
+		for (i = 0; i < n; i++)
+			STACK_AT(stack, i) = LE32(vals[n - 1 - i]);
+	}
+	stack->len += n;
+	return (EXIT_SUCCESS);
+}
+
+/**
+ * stack_save - Writes the values of a stack_t in the order load pushes
+ * them back: bottom first in stack mode, front first in queue mode.
+ * @stack: The stack_t.
+ * @fd: The file.
+ *
+ * Return: EXIT_SUCCESS, EXIT_FAILURE if malloc fails, or STACK_IO if the
+ * file can't be written or the spill file read.
+ */
+int stack_save(stack_t *stack, int fd)
+{
+	int rev = stack->mode == STACK, status;
+
+	if (rev)
+	{
+		status = save_spill(stack, fd, rev);
+		if (status == EXIT_SUCCESS)
+			status = save_ring(stack, fd, rev);
+		return (status);
+	}
+	status = save_ring(stack, fd, rev);
+	if (status == EXIT_SUCCESS)
+		status = save_spill(stack, fd, rev);
+	return (status);
+}
+
+/**
+ * save_ring - Writes the ring buffer of a stack_t with one system call.
+ * @stack: The stack_t.
+ * @fd: The file.
+ * @rev: Non-zero to write it bottom first.
+ *
+ * The ring buffer is already in queue order, so it is written in place
+ * with writev; otherwise it is copied out first.
+ *
+ * Return: As for stack_save.
+ */
+int save_ring(stack_t *stack, int fd, int rev)
+{
+	struct iovec iov[2];
+	size_t first = stack->cap - stack->head, i, size, done;
+	ssize_t got;
+	int *buf, status;
+
+	if (!rev && LE_HOST)
+	{
+		first = first < stack->len ? first : stack->len;
+		iov[0].iov_base = stack->vals + stack->head;
+		iov[0].iov_len = sizeof(int) * first;
+		iov[1].iov_base = stack->vals;
+		iov[1].iov_len = sizeof(int) * (stack->len - first);
+		got = writev(fd, iov, 2);
+		if (got < 0)
+			return (STACK_IO);
+		done = got;
+		for (i = 0, status = EXIT_SUCCESS; i < 2 && !status; i++)
+		{
+			size = done < iov[i].iov_len ? done : iov[i].iov_len;
+			done -= size;
+			status = write_full(fd, (char *)iov[i].iov_base + size,
+					    iov[i].iov_len - size);
+		}
+		return (status ? STACK_IO : EXIT_SUCCESS);
+	}
+	buf = malloc(sizeof(int) * (stack->len + 1));
+	if (buf == NULL)
+		return (EXIT_FAILURE);
+	for (i = 0; i < stack->len; i++)
+		buf[i] = LE32(STACK_AT(stack, rev ? stack->len - 1 - i : i));
+	status = write_full(fd, buf, sizeof(int) * stack->len);
+	free(buf);
+	return (status ? STACK_IO : EXIT_SUCCESS);
+}
+
+/**
+ * save_spill - Writes the values a stack_t has paged out with --spill.
+ * @stack: The stack_t.
+ * @fd: The file.
+ * @rev: Non-zero to write them bottom first.
+ *
+ * The chunks and the tail are written one at a time, through the
+ * spill's scratch buffer.
+ *
+ * Return: As for stack_save.
+ */
+int save_spill(stack_t *stack, int fd, int rev)
+{
+	spill_t *sp = stack->spill;
+	size_t k, i, j, n, count;
+	int *buf, tmp;
+
+	if (sp == NULL || sp->len == 0)
+		return (EXIT_SUCCESS);
+	buf = sp->buf;
+	count = sp->n_chunks + 1;
+	for (k = 0; k < count; k++)
+	{
+		i = rev ? count - 1 - k : k;
+		if (i == sp->n_chunks)
+		{
+			n = sp->tail_len;
+			memcpy(buf, sp->tail, sizeof(int) * n);
+		}
+		else if (spill_read(sp, i, buf) != EXIT_SUCCESS)
+			return (STACK_IO);
+		else
+			n = sp->chunks[i].len;
+		for (j = 0; rev && j < n / 2; j++)
+		{
+			tmp = buf[j];
+			buf[j] = buf[n - 1 - j];
+			buf[n - 1 - j] = tmp;
+		}
+		for (j = 0; !LE_HOST && j < n; j++)
+			buf[j] = LE32(buf[j]);
+		if (write_full(fd, buf, sizeof(int) * n) != EXIT_SUCCESS)
+			return (STACK_IO);
+	}
+	return (EXIT_SUCCESS);
+}
@@ -0,0 +1,175 @@
+#include "monty.h"
+#include <string.h>
+
+int bf_read(FILE *bf_fd, char **src, unsigned int **lines, size_t *n);
+int bf_bracket(prog_t *prog, char c, unsigned int line,
+	       int *open, size_t *depth);
+int bf_compile(FILE *bf_fd, prog_t *prog, int optimize);
+int run_bf(FILE *bf_fd, int optimize);
+
+/**
+ * bf_read - Reads the commands of a Brainfuck program, dropping comments.
+ * @bf_fd: The Brainfuck source.
+ * @src: Set to a malloc'ed array of the eight command characters.
+ * @lines: Set to a malloc'ed array holding the line of each command.
+ * @n: Set to the number of commands.
+ *
+ * Return: EXIT_SUCCESS, or EXIT_FAILURE if malloc fails.
+ */
+int bf_read(FILE *bf_fd, char **src, unsigned int **lines, size_t *n)
+{
+	size_t cap = 0;
+	unsigned int line = 1;
+	int c;
+	char *s;
+	unsigned int *l;
+
+	*n = 0;
+	while ((c = getc(bf_fd)) != EOF)
+	{
+		if (c == '\n')
+			line++;
+		if (c == 0 || strchr("+-<>.,[]", c) == NULL)
+			continue;
+		if (*n == cap)
+		{
+			cap = cap ? cap * 2 : 256;
+			s = realloc(*src, cap);
+			l = realloc(*lines, sizeof(unsigned int) * cap);
+			if (s != NULL)
+				*src = s;
+			if (l != NULL)
+				*lines = l;
+			if (s == NULL || l == NULL)
+				return (malloc_error());
+		}
+		(*src)[*n] = c;
+		(*lines)[(*n)++] = line;
+	}
+	return (EXIT_SUCCESS);
+}
+
+/**
+ * bf_bracket - Emits the jump for a [ or ] and links matching pairs.
+ * @prog: The program being compiled.
+ * @c: The bracket.
+ * @line: Its line in the Brainfuck source.
+ * @open: Instruction indices of the unmatched [ seen so far.
+ * @depth: Number of entries in @open.
+ *
+ * [ becomes jz past the matching ], and ] becomes jnz back past the
+ * matching [, so both targets are known before the program runs.
+ *
+ * Return: EXIT_SUCCESS, or EXIT_FAILURE after printing an error.
+ */
+int bf_bracket(prog_t *prog, char c, unsigned int line,
+	       int *open, size_t *depth)
+{
+	int o;
+
+	if (c == '[')
+	{
+		open[(*depth)++] = prog->len;
+		return (emit_instr(prog, OP_JZ, 0, line));
+	}
+	if (*depth == 0)
+		return (label_error(line, "unmatched", "]"));
+	o = open[--(*depth)];
+	prog->code[o].arg = prog->len + 1;
+	return (emit_instr(prog, OP_JNZ, o + 1, line));
+}
+
+/**
+ * bf_compile - Translates a Brainfuck program into Monty VM instructions.
+ * @bf_fd: The Brainfuck source.
+ * @prog: The program to fill in; release it with free_program.
+ * @optimize: When 0, every command becomes its own instruction, which
+ * gives the naive interpreter used as a baseline.
+ *
+ * Return: EXIT_SUCCESS, or EXIT_FAILURE after printing an error.
+ */
+int bf_compile(FILE *bf_fd, prog_t *prog, int optimize)
+{
+	char *src = NULL;
+	unsigned int *lines = NULL;
+	int *open = NULL, status;
+	size_t n = 0, i = 0, depth = 0;
+	long used;
+
+	memset(prog, 0, sizeof(*prog));
+	status = bf_read(bf_fd, &src, &lines, &n);
+	if (status == EXIT_SUCCESS && n > 0)
+	{
+		open = malloc(sizeof(int) * n);
+		if (open == NULL)
+			status = malloc_error();
+	}
+	while (status == EXIT_SUCCESS && i < n)
+	{
+		used = 0;
+		if (optimize && src[i] == '[')
+			used = bf_emit_idiom(prog, src + i, n - i, lines[i]);
+		if (used == 0 && (src[i] == '[' || src[i] == ']'))
+		{
+			status = bf_bracket(prog, src[i], lines[i], open,
+					    &depth);
+			used = 1;
+		}
+		else if (used == 0)
+			used = bf_emit_run(prog, src + i, n - i, lines[i],
+					   optimize);
+		if (used < 0)
+			status = EXIT_FAILURE;
+		i += used;
+	}
+	if (status == EXIT_SUCCESS && depth > 0)
+		status = label_error(prog->code[open[depth - 1]].line,
+				     "unmatched", "[");
+	free(src);
+	free(lines);
+	free(open);
+	return (status);
+}
+
+/**
+ * run_bf - Compiles and runs a Brainfuck program on the Monty VM.
+ * @bf_fd: The Brainfuck source.
+ * @optimize: Passed on to bf_compile.
+ *
+ * Return: EXIT_SUCCESS, or EXIT_FAILURE on error.
+ */
+int run_bf(FILE *bf_fd, int optimize)
+{
+	stack_t *tape = NULL;
+	prog_t prog;
+	int status;
+
+	if (bf_compile(bf_fd, &prog, optimize) == EXIT_FAILURE ||
+	    (!opts.emit_c && init_stack(&tape) == EXIT_FAILURE))
+	{
+		free_program(&prog);
+		return (EXIT_FAILURE);
+	}
+	if (opts.emit_c)
+	{
+		status = emit_c(&prog, stdout, 1);
+		free_program(&prog);
+		return (status);
+	}
+	while (tape->cap < BF_TAPE)
+	{
+		if (stack_grow(tape) != EXIT_SUCCESS)
+		{
+			free_stack(&tape);
+			free_program(&prog);
+			return (malloc_error());
+		}
+	}
+	memset(tape->vals, 0, sizeof(int) * tape->cap);
+	tape->len = tape->cap;
+
+	status = exec_program(&prog, &tape);
+	free_stack(&tape);
+	free_program(&prog);
+	return (status);
+}
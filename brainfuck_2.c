@@ -0,0 +1,133 @@
+#include "monty.h"
+
+#define BF_MUL_MAX 16
+
+long bf_emit_run(prog_t *prog, char *src, size_t n, unsigned int line,
+		 int optimize);
+long bf_emit_idiom(prog_t *prog, char *src, size_t n, unsigned int line);
+int bf_emit_mul(prog_t *prog, int *offs, int *deltas, int count,
+		unsigned int line);
+
+/**
+ * bf_emit_run - Emits one instruction for a run of +/-, </> or a . or ,
+ * @prog: The program being compiled.
+ * @src: The Brainfuck commands starting at the run.
+ * @n: Number of commands left in @src.
+ * @line: Line of the first command of the run.
+ * @optimize: When 0, runs are not collapsed.
+ *
+ * Runs of + and - become a single bf_add of their sum, and runs of < and
+ * > a single rotn of the tape by their net movement.
+ *
+ * Return: The number of commands consumed, or -1 if malloc fails.
+ */
+long bf_emit_run(prog_t *prog, char *src, size_t n, unsigned int line,
+		 int optimize)
+{
+	size_t i;
+	int delta = 0, op;
+
+	if (src[0] == '.' || src[0] == ',')
+	{
+		op = src[0] == '.' ? OP_BF_OUT : OP_BF_IN;
+		return (emit_instr(prog, op, 0, line) == EXIT_FAILURE ? -1 : 1);
+	}
+	op = (src[0] == '+' || src[0] == '-') ? OP_BF_ADD : OP_ROTN;
+	for (i = 0; i < n && (i == 0 || optimize); i++)
+	{
+		if (op == OP_BF_ADD && (src[i] == '+' || src[i] == '-'))
+			delta += src[i] == '+' ? 1 : -1;
+		else if (op == OP_ROTN && (src[i] == '>' || src[i] == '<'))
+			delta += src[i] == '>' ? 1 : -1;
+		else
+			break;
+	}
+
+	if (op == OP_BF_ADD)
+		delta &= 0xff;
+	if (delta == 0)
+		return (i);
+	if (emit_instr(prog, op, delta, line) == EXIT_FAILURE)
+		return (-1);
+	return (i);
+}
+
+/**
+ * bf_emit_idiom - Replaces a clear or multiply loop with direct updates.
+ * @prog: The program being compiled.
+ * @src: The Brainfuck commands starting at a [.
+ * @n: Number of commands left in @src.
+ * @line: Line of the [.
+ *
+ * Description: A loop whose body only uses + - < >, returns to its start
+ * cell and changes that cell by exactly 1 per pass runs v or 256 - v
+ * times, so each other cell it touches just gains a multiple of v.
+ * [-] and [+] are the case with no other cells.
+ *
+ * Return: The number of commands consumed, 0 if the loop is not such an
+ * idiom, or -1 if malloc fails.
+ */
+long bf_emit_idiom(prog_t *prog, char *src, size_t n, unsigned int line)
+{
+	int offs[BF_MUL_MAX], deltas[BF_MUL_MAX], count = 1, ptr = 0, k;
+	size_t i;
+
+	offs[0] = 0;
+	deltas[0] = 0;
+	for (i = 1; i < n && src[i] != ']'; i++)
+	{
+		if (src[i] == '<' || src[i] == '>')
+		{
+			ptr += src[i] == '>' ? 1 : -1;
+			continue;
+		}
+		if (src[i] != '+' && src[i] != '-')
+			return (0);
+		for (k = 0; k < count && offs[k] != ptr; k++)
+			;
+		if (k == count)
+		{
+			if (count == BF_MUL_MAX)
+				return (0);
+			offs[count] = ptr;
+			deltas[count++] = 0;
+		}
+		deltas[k] += src[i] == '+' ? 1 : -1;
+	}
+	if (i == n || ptr != 0 || ((deltas[0] & 0xff) != 1 &&
+				   (deltas[0] & 0xff) != 0xff))
+		return (0);
+	if (bf_emit_mul(prog, offs, deltas, count, line) == EXIT_FAILURE)
+		return (-1);
+	return (i + 1);
+}
+
+/**
+ * bf_emit_mul - Emits the bf_mul steps and final clear of an idiom loop.
+ * @prog: The program being compiled.
+ * @offs: Cell offsets touched by the loop, offs[0] being 0.
+ * @deltas: Change of each cell per pass.
+ * @count: Number of entries in @offs and @deltas.
+ * @line: Line of the loop.
+ *
+ * Return: EXIT_SUCCESS, or EXIT_FAILURE if malloc fails.
+ */
+int bf_emit_mul(prog_t *prog, int *offs, int *deltas, int count,
+		unsigned int line)
+{
+	int k, factor;
+
+	for (k = 1; k < count; k++)
+	{
+		factor = deltas[k];
+		if ((deltas[0] & 0xff) == 1)
+			factor = -factor;
+		factor &= 0xff;
+		if (factor == 0)
+			continue;
+		if (emit_instr(prog, OP_BF_MUL, offs[k] * 256 + factor,
+			       line) == EXIT_FAILURE)
+			return (EXIT_FAILURE);
+	}
+	return (emit_instr(prog, OP_BF_CLEAR, 0, line));
+}
@@ -0,0 +1,181 @@
+#include "monty.h"
+#include <string.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+int load_cached(FILE *script_fd, prog_t *prog);
+int cache_path(char *buf, size_t size, unsigned long hash, char *ext);
+int cache_load(char *path, char *src, size_t len, prog_t *prog);
+int cache_map(prog_t *prog, char *map, cache_hdr_t *hdr);
+
+/**
+ * load_cached - Loads a program through the disk cache.
+ * @script_fd: The script.
+ * @prog: The program to fill in.
+ *
+ * Description: The script is read whole and hashed; a valid cache entry
+ * for it is mapped instead of decoding the script, otherwise the script
+ * is decoded and stored. Any cache problem just falls back to decoding.
+ *
+ * Return: EXIT_SUCCESS, or EXIT_FAILURE on error.
+ */
+int load_cached(FILE *script_fd, prog_t *prog)
+{
+	char path[4096], *src;
+	size_t len;
+	int status, cached;
+
+	src = read_stream(script_fd, &len);
+	if (src == NULL)
+	{
+		memset(prog, 0, sizeof(*prog));
+		return (malloc_error());
+	}
+	cached = cache_path(path, sizeof(path), hash_bytes(src, len),
+			    "mc");
+	if (cached == EXIT_SUCCESS &&
+	    cache_load(path, src, len, prog) == EXIT_SUCCESS)
+	{
+		free(src);
+		return (EXIT_SUCCESS);
+	}
+	status = load_program_mem(src, len, prog);
+	if (status == EXIT_SUCCESS && cached == EXIT_SUCCESS)
+		cache_store(path, src, len, prog);
+	free(src);
+	return (status);
+}
+
+/**
+ * cache_path - Builds the path of a cache entry, creating the cache
+ * directory if needed.
+ * @buf: Where to store the path.
+ * @size: Size of @buf.
+ * @hash: hash_bytes of what the entry is for.
+ * @ext: Extension telling the kinds of entries apart.
+ *
+ * Description: Entries live in $XDG_CACHE_HOME/monty, or ~/.cache/monty,
+ * and are named after the hash, CACHE_VERSION and @ext, so an interpreter
+ * that decodes differently never even opens another version's entries.
+ *
+ * Return: EXIT_SUCCESS, or EXIT_FAILURE if there is no usable directory.
+ */
+int cache_path(char *buf, size_t size, unsigned long hash, char *ext)
+{
+	char *base = getenv("XDG_CACHE_HOME");
+	int n;
+
+	if (base != NULL && base[0] == '/')
+		n = snprintf(buf, size, "%s/monty", base);
+	else if (getenv("HOME") != NULL)
+	{
+		n = snprintf(buf, size, "%s/.cache", getenv("HOME"));
+		if (n > 0 && (size_t)n < size)
+			mkdir(buf, 0700);
+		n = snprintf(buf, size, "%s/.cache/monty", getenv("HOME"));
+	}
+	else
+		return (EXIT_FAILURE);
+	if (n <= 0 || (size_t)n >= size)
+		return (EXIT_FAILURE);
+	mkdir(buf, 0700);
+	size -= n;
+	n = snprintf(buf + n, size, "/%016lx-%lx.%s", hash,
+		     (unsigned long)CACHE_VERSION, ext);
+	if (n <= 0 || (size_t)n >= size)
+		return (EXIT_FAILURE);
+	return (EXIT_SUCCESS);
+}
+
+/**
+ * cache_load - Maps the cache entry of a source, if it is valid.
+ * @path: Path of the entry.
+ * @src: The source.
+ * @len: Length of the source.
+ * @prog: The program to fill in.
+ *
+ * Description: The entry keeps a copy of the source, so a hash collision
+ * or a stale entry is a miss rather than a wrong program. Entries are
+ * only ever replaced by rename(), so a mapping never changes under us.
+ *
+ * Return: EXIT_SUCCESS on a hit, EXIT_FAILURE otherwise.
+ */
+int cache_load(char *path, char *src, size_t len, prog_t *prog)
+{
+	struct stat st;
+	cache_hdr_t *hdr;
+	char *map;
+	int fd;
+
+	fd = open(path, O_RDONLY);
+	if (fd == -1)
+		return (EXIT_FAILURE);
+	if (fstat(fd, &st) == -1 || (size_t)st.st_size < sizeof(*hdr))
+	{
+		close(fd);
+		return (EXIT_FAILURE);
+	}
+	map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED)
+		return (EXIT_FAILURE);
+	hdr = (cache_hdr_t *)map;
+	memset(prog, 0, sizeof(*prog));
+	prog->map = map;
+	prog->map_len = st.st_size;
+	if (memcmp(hdr->magic, CACHE_MAGIC, 8) != 0 ||
+	    hdr->version != CACHE_VERSION || hdr->src_len != len ||
+	    hdr->n_code > (st.st_size - sizeof(*hdr)) / sizeof(instr_t) ||
+	    hdr->n_pool > (st.st_size - sizeof(*hdr)) / sizeof(int) ||
+	    sizeof(*hdr) + hdr->n_code * sizeof(instr_t) +
+	    hdr->n_pool * sizeof(int) + hdr->names_len +
+	    len != (size_t)st.st_size || hdr->n_names > hdr->names_len ||
+	    hdr->hash != hash_bytes(src, len) ||
+	    memcmp(map + st.st_size - len, src, len) != 0 ||
+	    cache_map(prog, map, hdr) == EXIT_FAILURE)
+	{
+		free_program(prog);
+		return (EXIT_FAILURE);
+	}
+	return (EXIT_SUCCESS);
+}
+
+/**
+ * cache_map - Points a program at the contents of a mapped cache entry.
+ * @prog: The program, with map and map_len already set.
+ * @map: The mapping.
+ * @hdr: The entry header, at the start of the mapping.
+ *
+ * Return: EXIT_SUCCESS, or EXIT_FAILURE if the entry is malformed.
+ */
+int cache_map(prog_t *prog, char *map, cache_hdr_t *hdr)
+{
+	char *name, *end;
+	size_t i;
+
+	prog->code = (instr_t *)(map + sizeof(*hdr));
+	prog->len = hdr->n_code;
+	prog->nul_tail = hdr->nul_tail != 0;
+	prog->names = malloc(sizeof(char *) * (hdr->n_names + 1));
+	if (prog->names == NULL)
+		return (EXIT_FAILURE);
+	prog->pool = (int *)(prog->code + prog->len);
+	prog->pool_len = hdr->n_pool;
+	name = (char *)(prog->pool + prog->pool_len);
+	end = name + hdr->names_len;
+	for (i = 0; i < hdr->n_names; i++)
+	{
+		prog->names[i] = name;
+		name = memchr(name, '\0', end - name);
+		if (name == NULL)
+			return (EXIT_FAILURE);
+		name++;
+	}
+	if (name != end)
+		return (EXIT_FAILURE);
+	prog->n_names = hdr->n_names;
+	if (hdr->sum != cache_sum(prog))
+		return (EXIT_FAILURE);
+	return (cache_check(prog));
+}
@@ -0,0 +1,127 @@
+#include "monty.h"
+#include <string.h>
+#include <fcntl.h>
+
+int cache_store(char *path, char *src, size_t len, prog_t *prog);
+int cache_check(prog_t *prog);
+unsigned long cache_sum(prog_t *prog);
+
+/**
+ * cache_store - Writes the cache entry of a decoded program.
+ * @path: Path of the entry.
+ * @src: The source.
+ * @len: Length of the source.
+ * @prog: The decoded program.
+ *
+ * Description: The entry is written to a temporary file that is renamed
+ * into place, so concurrent runs only ever see complete entries.
+ *
+ * Return: EXIT_SUCCESS, or EXIT_FAILURE if the entry was not written.
+ */
+int cache_store(char *path, char *src, size_t len, prog_t *prog)
+{
+	char tmp[4200];
+	cache_hdr_t hdr;
+	size_t i;
+	int fd, status;
+
+	memset(&hdr, 0, sizeof(hdr));
+	memcpy(hdr.magic, CACHE_MAGIC, 8);
+	hdr.version = CACHE_VERSION;
+	hdr.hash = hash_bytes(src, len);
+	hdr.src_len = len;
+	hdr.n_code = prog->len;
+	hdr.n_names = prog->n_names;
+	hdr.n_pool = prog->pool_len;
+	hdr.nul_tail = prog->nul_tail;
+	hdr.sum = cache_sum(prog);
+	for (i = 0; i < prog->n_names; i++)
+		hdr.names_len += strlen(prog->names[i]) + 1;
+	snprintf(tmp, sizeof(tmp), "%s.%ld.tmp", path, (long)getpid());
+	fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+	if (fd == -1)
+		return (EXIT_FAILURE);
+	status = write_full(fd, &hdr, sizeof(hdr));
+	if (status == EXIT_SUCCESS)
+		status = write_full(fd, prog->code,
+				    prog->len * sizeof(instr_t));
+	if (status == EXIT_SUCCESS)
+		status = write_full(fd, prog->pool,
+				    prog->pool_len * sizeof(int));
+	for (i = 0; status == EXIT_SUCCESS && i < prog->n_names; i++)
+		status = write_full(fd, prog->names[i],
+				    strlen(prog->names[i]) + 1);
+	if (status == EXIT_SUCCESS)
+		status = write_full(fd, src, len);
+	if (close(fd) == -1 || status == EXIT_FAILURE ||
+	    rename(tmp, path) == -1)
+	{
+		unlink(tmp);
+		return (EXIT_FAILURE);
+	}
+	return (EXIT_SUCCESS);
+}
+
+/**
+ * cache_check - Checks that the instructions of a mapped entry are safe
+ * to execute.
+ * @prog: The program.
+ *
+ * Return: EXIT_SUCCESS, or EXIT_FAILURE if an opcode, name index, jump
+ * target, pool literal or opcode operand is out of range.
+ */
+int cache_check(prog_t *prog)
+{
+	instr_t *in;
+	size_t i;
+
+	for (i = 0; i < prog->len; i++)
+	{
+		in = &prog->code[i];
+		if (in->op < 0 || in->op > OP_BAD_ARG)
+			return (EXIT_FAILURE);
+		if (op_table[in->op].operand == OPND_STACK &&
+		    (in->arg < 0 || in->arg >= STACK_BANK))
+			return (EXIT_FAILURE);
+		if (op_table[in->op].operand == OPND_INDEX && in->arg < 0)
+			return (EXIT_FAILURE);
+		if ((op_table[in->op].operand == OPND_LABEL ||
+		     in->op == OP_DEF) &&
+		    (in->arg < 0 || (size_t)in->arg > prog->len))
+			return (EXIT_FAILURE);
+		if ((in->op == OP_BAD_OP ||
+		     op_table[in->op].operand == OPND_PATH) &&
+		    (in->arg < 0 || (size_t)in->arg >= prog->n_names))
+			return (EXIT_FAILURE);
+		if ((op_table[in->op].operand == OPND_STRING ||
+		     op_table[in->op].operand == OPND_LIST) &&
+		    (in->arg < 0 || (size_t)in->arg >= prog->pool_len ||
+		     prog->pool[in->arg] < 0 || (size_t)prog->pool[in->arg] >=
+		     prog->pool_len - in->arg))
+			return (EXIT_FAILURE);
+		if (in->op == OP_BAD_ARG &&
+		    (in->arg < 0 || in->arg >= OP_BAD_OP))
+			return (EXIT_FAILURE);
+	}
+	return (EXIT_SUCCESS);
+}
+
+/**
+ * cache_sum - Hashes the instructions, pool and names of a program.
+ * @prog: The program.
+ *
+ * Return: The hash, chained over the instructions, the pool and each name.
+ */
+unsigned long cache_sum(prog_t *prog)
+{
+	unsigned long sum;
+	size_t i;
+
+	sum = hash_bytes((char *)prog->code, prog->len * sizeof(instr_t));
+	sum = sum * 31 + hash_bytes((char *)prog->pool,
+				    prog->pool_len * sizeof(int));
+	for (i = 0; i < prog->n_names; i++)
+		sum = sum * 31 + hash_bytes(prog->names[i],
+					    strlen(prog->names[i]));
+	return (sum);
+}
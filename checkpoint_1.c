@@ -0,0 +1,124 @@
+/* fopencookie is a GNU extension */
+#define _GNU_SOURCE
+/* signal.h has its own stack_t (for sigaltstack); keep it out of the way */
+#define stack_t sig_stack_t
+#include <sys/wait.h>
+#undef stack_t
+#include "monty.h"
+#include <string.h>
+
+int ckpt_run(prog_t *prog, stack_t **stack);
+void ckpt_fork(ckpt_t *ck, stack_t *stack);
+ssize_t ckpt_out_write(void *cookie, const char *buf, size_t size);
+
+/**
+ * ckpt_run - Runs a program with --checkpoint-every and/or --resume.
+ * @prog: The decoded program.
+ * @stack: The stack_t the program operates on.
+ *
+ * Description: stdout is replaced by a stream that counts what it writes,
+ * so a snapshot knows how much output the run had produced; how much of
+ * stdin read has used is kept too. Snapshots go to "<script>.ckpt",
+ * taken before the instruction at their ip.
+ *
+ * Return: EXIT_SUCCESS, or the exit code of the first opcode that failed.
+ */
+int ckpt_run(prog_t *prog, stack_t **stack)
+{
+	cookie_io_functions_t io = {NULL, ckpt_out_write, NULL, NULL};
+	ckpt_t ck;
+	unsigned long next = opts.ckpt_every;
+	instr_t *in;
+	FILE *out;
+
+	memset(&ck, 0, sizeof(ck));
+	ck.sum = cache_sum(prog);
+	ck.path = malloc(strlen(opts.script) + sizeof(".ckpt"));
+	if (ck.path == NULL)
+		return (malloc_error());
+	sprintf(ck.path, "%s.ckpt", opts.script);
+	ck.seek = lseek(STDIN_FILENO, 0, SEEK_CUR) != -1;
+	ck.start = ckpt_out_start();
+	vm.prog = prog;
+	vm.ip = 0;
+	vm.rsp = 0;
+	vm.status = EXIT_SUCCESS;
+	if (opts.resume != NULL && ckpt_resume(&ck, stack) == EXIT_FAILURE)
+	{
+		free(ck.path);
+		return (resume_error(opts.resume));
+	}
+	fflush(stdout);
+	out = fopencookie(&ck, "w", io);
+	if (out != NULL)
+	{
+		setvbuf(out, NULL, isatty(STDOUT_FILENO) ? _IOLBF : _IOFBF,
+			BUFSIZ);
+		stdout = out;
+	}
+	while (vm.ip < prog->len && vm.status == EXIT_SUCCESS)
+	{
+		if (next != 0 && --next == 0)
+		{
+			ckpt_fork(&ck, *stack);
+			next = opts.ckpt_every;
+		}
+		in = &prog->code[vm.ip++];
+		vm.arg = in->arg;
+		op_table[in->op].f(stack, in->line);
+	}
+	fflush(stdout);
+	if (ck.pid > 0)
+		waitpid(ck.pid, NULL, 0);
+	free(ck.path);
+	return (vm.status);
+}
+
+/**
+ * ckpt_fork - Takes a snapshot in a child process.
+ * @ck: The checkpoint state.
+ * @stack: The stack_t of the running program.
+ *
+ * The child gets a copy-on-write view of the VM and writes it out while
+ * the parent keeps running. If the previous child has not finished yet
+ * this snapshot is skipped rather than waited for. Once read has taken
+ * input from a stdin that cannot seek, no more snapshots are taken: a
+ * resumed run could not get back to the same place in it.
+ */
+void ckpt_fork(ckpt_t *ck, stack_t *stack)
+{
+	pid_t pid;
+
+	if (!ck->seek && vm.in->off > 0)
+		return;
+	if (ck->pid > 0)
+	{
+		if (waitpid(ck->pid, NULL, WNOHANG) == 0)
+			return;
+		ck->pid = 0;
+	}
+	fflush(stdout);
+	pid = fork();
+	if (pid == 0)
+		_exit(ckpt_write(ck, stack));
+	if (pid > 0)
+		ck->pid = pid;
+}
+
+/**
+ * ckpt_out_write - Writes stdout data, counting it.
+ * @cookie: The checkpoint state.
+ * @buf: The data.
+ * @size: Number of bytes.
+ *
+ * Return: @size, or 0 on error.
+ */
+ssize_t ckpt_out_write(void *cookie, const char *buf, size_t size)
+{
+	ckpt_t *ck = cookie;
+
+	if (write_full(STDOUT_FILENO, buf, size) == EXIT_FAILURE)
+		return (0);
+	ck->out += size;
+	return (size);
+}
@@ -0,0 +1,173 @@
+#include "monty.h"
+#include <string.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+int ckpt_resume(ckpt_t *ck, stack_t **stack);
+int ckpt_read_stack(int fd, stack_t *s);
+int ckpt_read_map(int fd, map_t **map);
+int ckpt_restore_out(ckpt_t *ck);
+unsigned long ckpt_out_start(void);
+
+/**
+ * ckpt_resume - Restores the VM from the snapshot given with --resume.
+ * @ck: The checkpoint state.
+ * @stack: Pointer to the program's empty stack bank; set to the stack
+ * that was selected.
+ *
+ * stdin is expected to be the one the interrupted run had, from the same
+ * place; it is moved past the input the snapshot had used.
+ *
+ * Return: EXIT_SUCCESS, or EXIT_FAILURE if the snapshot is unreadable,
+ * was taken from another program or interpreter version, or has used
+ * input from a stdin that cannot seek.
+ */
+int ckpt_resume(ckpt_t *ck, stack_t **stack)
+{
+	ckpt_hdr_t hdr;
+	int fd, i, status;
+
+	fd = open(opts.resume, O_RDONLY);
+	if (fd == -1)
+		return (EXIT_FAILURE);
+	status = read_full(fd, &hdr, sizeof(hdr));
+	if (status == EXIT_FAILURE || memcmp(hdr.magic, CKPT_MAGIC, 8) != 0 ||
+	    hdr.version != CACHE_VERSION || hdr.sum != ck->sum ||
+	    hdr.ip > vm.prog->len || hdr.cur >= STACK_BANK ||
+	    hdr.rsp > RET_DEPTH)
+	{
+		close(fd);
+		return (EXIT_FAILURE);
+	}
+	for (i = 0; i < STACK_BANK && status == EXIT_SUCCESS; i++)
+		status = ckpt_read_stack(fd, *stack + i);
+	if (status == EXIT_SUCCESS)
+		status = read_full(fd, vm.ret, hdr.rsp * sizeof(size_t));
+	if (status == EXIT_SUCCESS)
+		status = ckpt_read_map(fd, &(*stack)->map);
+	close(fd);
+	for (vm.rsp = 0; status == EXIT_SUCCESS && vm.rsp < hdr.rsp; vm.rsp++)
+		if (vm.ret[vm.rsp] > vm.prog->len)
+			status = EXIT_FAILURE;
+	if (status == EXIT_FAILURE || (hdr.in > 0 && (!ck->seek ||
+	    lseek(STDIN_FILENO, hdr.in, SEEK_CUR) == -1)))
+		return (EXIT_FAILURE);
+	vm.in->off = hdr.in;
+	*stack += hdr.cur;
+	vm.ip = hdr.ip;
+	ck->start = hdr.start;
+	ck->out = hdr.out;
+	return (ckpt_restore_out(ck));
+}
+
+/**
+ * ckpt_read_stack - Reads one stack of a snapshot.
+ * @fd: The snapshot file.
+ * @s: The empty stack_t to fill in.
+ *
+ * Return: EXIT_SUCCESS, or EXIT_FAILURE on error.
+ */
+int ckpt_read_stack(int fd, stack_t *s)
+{
+	unsigned long info[2];
+
+	if (read_full(fd, info, sizeof(info)) == EXIT_FAILURE ||
+	    (info[0] != STACK && info[0] != QUEUE) || info[1] > 0x7fffffffUL)
+		return (EXIT_FAILURE);
+	while (s->cap < info[1])
+		if (stack_grow(s) != EXIT_SUCCESS)
+			return (EXIT_FAILURE);
+	if (read_full(fd, s->vals, info[1] * sizeof(int)) == EXIT_FAILURE)
+		return (EXIT_FAILURE);
+	s->head = 0;
+	s->len = info[1];
+	s->mode = info[0];
+	return (EXIT_SUCCESS);
+}
+
+/**
+ * ckpt_read_map - Reads the map of a snapshot.
+ * @fd: The snapshot file.
+ * @map: The empty map slot of the bank to fill in.
+ *
+ * The slots are taken as they are; a table too full to ever end a probe
+ * is refused.
+ *
+ * Return: EXIT_SUCCESS, or EXIT_FAILURE on error.
+ */
+int ckpt_read_map(int fd, map_t **map)
+{
+	unsigned long info[3];
+	size_t i;
+
+	if (read_full(fd, info, sizeof(info)) == EXIT_FAILURE ||
+	    info[0] > 0x7fffffffUL || (info[0] & (info[0] - 1)) != 0 ||
+	    (info[0] != 0 && info[0] < MAP_INIT_CAP))
+		return (EXIT_FAILURE);
+	if (info[0] == 0 && info[1] == 0)
+		return (EXIT_SUCCESS);
+	if (map_put(map, MAP_EMPTY, (int)info[2]) != EXIT_SUCCESS)
+		return (EXIT_FAILURE);
+	(*map)->has_empty = info[1] != 0;
+	while ((*map)->cap < info[0])
+		if (map_grow(*map) != EXIT_SUCCESS)
+			return (EXIT_FAILURE);
+	if (read_full(fd, (*map)->slots, info[0] * sizeof(map_slot_t)) ==
+	    EXIT_FAILURE)
+		return (EXIT_FAILURE);
+	for (i = 0; i < info[0]; i++)
+		(*map)->len += (*map)->slots[i].key != MAP_EMPTY;
+	if (4 * (*map)->len > 3 * info[0])
+		return (EXIT_FAILURE);
+	return (EXIT_SUCCESS);
+}
+
+/**
+ * ckpt_restore_out - Lines stdout up with the output offset of a snapshot.
+ * @ck: The checkpoint state, with the snapshot's output offset.
+ *
+ * Description: If stdout is the regular file the interrupted run wrote
+ * to, whatever it printed after the snapshot is cut off, so the file ends
+ * up exactly as if the run had never stopped. The run's output need not
+ * have started at the beginning of the file (">>"). When that start is
+ * not known, and for other outputs, nothing is cut: they just get the
+ * rest of the output.
+ *
+ * Return: EXIT_SUCCESS.
+ */
+int ckpt_restore_out(ckpt_t *ck)
+{
+	struct stat st;
+	unsigned long end = ck->start + ck->out;
+
+	fflush(stdout);
+	if (ck->start != CKPT_NO_START && fstat(STDOUT_FILENO, &st) == 0 &&
+	    S_ISREG(st.st_mode) && (unsigned long)st.st_size >= end &&
+	    ftruncate(STDOUT_FILENO, end) == 0)
+		lseek(STDOUT_FILENO, end, SEEK_SET);
+	return (EXIT_SUCCESS);
+}
+
+/**
+ * ckpt_out_start - Finds where in stdout the output of a run begins.
+ *
+ * An append-only stdout (">>") writes at its end, wherever its offset is.
+ *
+ * Return: The offset, or CKPT_NO_START if stdout is not a regular file.
+ */
+unsigned long ckpt_out_start(void)
+{
+	struct stat st;
+	off_t off;
+	int flags;
+
+	fflush(stdout);
+	flags = fcntl(STDOUT_FILENO, F_GETFL);
+	if (flags == -1 || fstat(STDOUT_FILENO, &st) == -1 ||
+	    !S_ISREG(st.st_mode))
+		return (CKPT_NO_START);
+	if (flags & O_APPEND)
+		return (st.st_size);
+	off = lseek(STDOUT_FILENO, 0, SEEK_CUR);
+	return (off == -1 ? CKPT_NO_START : (unsigned long)off);
+}
@@ -0,0 +1,103 @@
+#include "monty.h"
+#include <string.h>
+#include <fcntl.h>
+
+int ckpt_write(ckpt_t *ck, stack_t *stack);
+int ckpt_write_stack(int fd, stack_t *s);
+int ckpt_write_map(int fd, map_t *map);
+
+/**
+ * ckpt_write - Writes a snapshot of the VM.
+ * @ck: The checkpoint state.
+ * @stack: The selected stack_t of the running program.
+ *
+ * The snapshot is written to a temporary file that is renamed over the
+ * previous one, so a crash mid-write leaves the previous one intact.
+ *
+ * Return: EXIT_SUCCESS, or EXIT_FAILURE if the snapshot was not written.
+ */
+int ckpt_write(ckpt_t *ck, stack_t *stack)
+{
+	ckpt_hdr_t hdr;
+	stack_t *bank = stack - stack->id;
+	char tmp[4200];
+	int fd, i, status;
+
+	memset(&hdr, 0, sizeof(hdr));
+	memcpy(hdr.magic, CKPT_MAGIC, 8);
+	hdr.version = CACHE_VERSION;
+	hdr.sum = ck->sum;
+	hdr.ip = vm.ip;
+	hdr.cur = stack->id;
+	hdr.start = ck->start;
+	hdr.out = ck->out;
+	hdr.in = vm.in->off - (vm.in->len - vm.in->pos);
+	hdr.rsp = vm.rsp;
+	snprintf(tmp, sizeof(tmp), "%s.%ld.tmp", ck->path, (long)getpid());
+	fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+	if (fd == -1)
+		return (EXIT_FAILURE);
+	status = write_full(fd, &hdr, sizeof(hdr));
+	for (i = 0; i < STACK_BANK && status == EXIT_SUCCESS; i++)
+		status = ckpt_write_stack(fd, &bank[i]);
+	if (status == EXIT_SUCCESS)
+		status = write_full(fd, vm.ret, vm.rsp * sizeof(size_t));
+	if (status == EXIT_SUCCESS)
+		status = ckpt_write_map(fd, bank->map);
+	if (close(fd) == -1 || status == EXIT_FAILURE ||
+	    rename(tmp, ck->path) == -1)
+	{
+		unlink(tmp);
+		return (EXIT_FAILURE);
+	}
+	return (EXIT_SUCCESS);
+}
+
+/**
+ * ckpt_write_stack - Writes one stack of a snapshot.
+ * @fd: The snapshot file.
+ * @s: The stack_t.
+ *
+ * Return: EXIT_SUCCESS, or EXIT_FAILURE on error.
+ */
+int ckpt_write_stack(int fd, stack_t *s)
+{
+	unsigned long info[2];
+	size_t first;
+
+	info[0] = s->mode;
+	info[1] = s->len;
+	first = s->cap - s->head;
+	if (first > s->len)
+		first = s->len;
+	if (write_full(fd, info, sizeof(info)) == EXIT_FAILURE ||
+	    write_full(fd, s->vals + s->head,
+		       first * sizeof(int)) == EXIT_FAILURE)
+		return (EXIT_FAILURE);
+	return (write_full(fd, s->vals, (s->len - first) * sizeof(int)));
+}
+
+/**
+ * ckpt_write_map - Writes the map of a snapshot: its size, the value of
+ * MAP_EMPTY, then its slots as they are.
+ * @fd: The snapshot file.
+ * @map: The map, or NULL.
+ *
+ * Return: EXIT_SUCCESS, or EXIT_FAILURE on error.
+ */
+int ckpt_write_map(int fd, map_t *map)
+{
+	unsigned long info[3] = {0, 0, 0};
+
+	if (map != NULL)
+	{
+		info[0] = map->cap;
+		info[1] = map->has_empty;
+		info[2] = (unsigned int)map->empty_val;
+	}
+	if (write_full(fd, info, sizeof(info)) == EXIT_FAILURE)
+		return (EXIT_FAILURE);
+	if (info[0] == 0)
+		return (EXIT_SUCCESS);
+	return (write_full(fd, map->slots, map->cap * sizeof(map_slot_t)));
+}
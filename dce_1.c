@@ -0,0 +1,177 @@
+#include "monty.h"
+
+void dce_trim(prog_t *prog);
+void dce_clamp(prog_t *prog, size_t cut);
+int dce_step(dce_t *st, prog_t *prog, instr_t *in);
+void dce_reset(dce_t *st);
+
+/**
+ * dce_trim - Drops the instructions at the end of a program that can
+ * neither print nor fail.
+ * @prog: The decoded program.
+ *
+ * Description: A forward pass follows what is known of the stack before
+ * each instruction (see dce_t); jump targets, and whatever follows
+ * control flow, start again from nothing known. An instruction is dead
+ * when it has no output or other side effect and that knowledge proves
+ * it cannot fail: a pop needs a value, a div a known divisor other than
+ * 0 (or -1, unless the dividend is known not to be INT_MIN). The longest
+ * run of dead instructions at the end of the program is cut off. Running
+ * it could only have changed values nothing prints.
+ *
+ * Nothing is dropped with --no-dce, with stack limits (a push may then
+ * fail) or when tracing, snapshots or --incremental see every
+ * instruction.
+ */
+void dce_trim(prog_t *prog)
+{
+	char *dead, *target;
+	size_t i, cut;
+	dce_t st;
+	instr_t *in;
+
+	if (opts.no_dce || opts.max_depth || opts.max_memory || opts.spill ||
+	    opts.trace || opts.ckpt_every || opts.resume || opts.incremental ||
+	    prog->len == 0)
+		return;
+	dead = malloc(prog->len);
+	target = calloc(prog->len + 1, 1);
+	if (dead == NULL || target == NULL)
+	{
+		free(dead);
+		free(target);
+		return;
+	}
+	for (i = 0; i < prog->len; i++)
+	{
+		in = &prog->code[i];
+		if (op_table[in->op].operand == OPND_LABEL || in->op == OP_DEF)
+			target[in->arg] = 1;
+	}
+	dce_reset(&st);
+	st.mode = STACK;
+	for (i = 0; i < prog->len; i++)
+	{
+		if (target[i])
+			dce_reset(&st);
+		dead[i] = dce_step(&st, prog, &prog->code[i]);
+	}
+	for (cut = prog->len; cut > 0 && dead[cut - 1]; cut--)
+		;
+	if (cut < prog->len)
+		dce_clamp(prog, cut);
+	free(dead);
+	free(target);
+}
+
+/**
+ * dce_clamp - Cuts a program short, moving jumps past the new end to it.
+ * @prog: The decoded program.
+ * @cut: Number of instructions to keep.
+ *
+ * Jumping to the new end stops the program just as running the dead
+ * instructions would have. The code of a program mapped from the disk
+ * cache is read-only, so it keeps the dead instructions up to the
+ * furthest jump target instead.
+ */
+void dce_clamp(prog_t *prog, size_t cut)
+{
+	size_t i, end = cut;
+	instr_t *in;
+
+	for (i = 0; i < cut; i++)
+	{
+		in = &prog->code[i];
+		if ((op_table[in->op].operand != OPND_LABEL &&
+		     in->op != OP_DEF) || (size_t)in->arg <= cut)
+			continue;
+		if (prog->map != NULL)
+			end = (size_t)in->arg > end ? (size_t)in->arg : end;
+		else
+			in->arg = cut;
+	}
+	prog->len = end;
+}
+
+/**
+ * dce_step - Updates what is known of the stack across one instruction.
+ * @st: What is known before the instruction; updated to after it, on
+ * the paths where it did not fail.
+ * @prog: The decoded program.
+ * @in: The instruction.
+ *
+ * Which stack is current is not followed, so movto and movfrom, which may
+ * name it, forget everything like control flow does.
+ *
+ * Return: 1 if the instruction is dead, else 0.
+ */
+int dce_step(dce_t *st, prog_t *prog, instr_t *in)
+{
+	int *lit, ok, tmp;
+	size_t n;
+
+	switch (in->op)
+	{
+	case OP_NOP:
+		return (1);
+	case OP_STACK: case OP_QUEUE:
+		st->mode = in->op == OP_STACK ? STACK : QUEUE;
+		return (1);
+	case OP_PUSH:
+		dce_push(st, 1, in->arg);
+		return (1);
+	case OP_PUSHS: case OP_PUSHN:
+		lit = prog->pool + in->arg;
+		for (n = lit[0]; n > 0; n--)
+			dce_push(st, 1, lit[n]);
+		return (1);
+	case OP_ROTL: case OP_ROTR: case OP_ROTN:
+		st->n_known = 0;
+		return (1);
+	case OP_POP: case OP_DEL: case OP_STORE:
+		n = in->op == OP_STORE ? 2 : 1;
+		ok = dce_need(st, n);
+		dce_pop(st, n);
+		return (ok);
+	case OP_SWAP: case OP_HAS: case OP_FETCH:
+		ok = dce_need(st, in->op == OP_SWAP ? 2 : 1);
+		if (in->op == OP_SWAP && st->n_known >= 2)
+		{
+			tmp = st->known[0];
+			st->known[0] = st->known[1];
+			st->known[1] = tmp;
+		}
+		else
+			st->n_known = 0;
+		return (ok && in->op != OP_FETCH);
+	case OP_ADD: case OP_SUB: case OP_MUL: case OP_DIV: case OP_MOD:
+		return (dce_math(st, in));
+	case OP_DUP: case OP_OVER: case OP_PICK: case OP_ROLL: case OP_DROP:
+		return (dce_index(st, in));
+	case OP_PINT: case OP_PCHAR:
+		dce_need(st, 1);
+		return (0);
+	case OP_PALL: case OP_PSTR: case OP_SAVE:
+		return (0);
+	case OP_READ:
+		dce_push(st, 0, 0);
+		return (0);
+	case OP_READALL: case OP_LOAD:
+		st->n_known = 0;
+		return (0);
+	default:
+		dce_reset(st);
+		return (0);
+	}
+}
+
+/**
+ * dce_reset - Forgets all about the stack.
+ * @st: What is known of the stack.
+ */
+void dce_reset(dce_t *st)
+{
+	st->depth = 0;
+	st->n_known = 0;
+	st->mode = -1;
+}
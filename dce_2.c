@@ -0,0 +1,132 @@
+#include "monty.h"
+#include <string.h>
+
+int dce_math(dce_t *st, instr_t *in);
+int dce_index(dce_t *st, instr_t *in);
+void dce_push(dce_t *st, int is_known, int n);
+void dce_pop(dce_t *st, size_t n);
+int dce_need(dce_t *st, size_t n);
+
+/**
+ * dce_math - Updates what is known of the stack across add, sub, mul,
+ * div or mod.
+ * @st: What is known before the instruction.
+ * @in: The instruction.
+ *
+ * Return: 1 if the instruction is dead, else 0.
+ */
+int dce_math(dce_t *st, instr_t *in)
+{
+	int ok = dce_need(st, 2), both = st->n_known >= 2, a, b;
+	unsigned int r = 0;
+
+	a = st->n_known >= 1 ? st->known[0] : 0;
+	b = both ? st->known[1] : 0;
+	if (in->op == OP_DIV || in->op == OP_MOD)
+		ok = ok && a != 0 && (a != -1 || (both && b != INT32_MIN));
+	if (in->op == OP_ADD)
+		r = (unsigned int)b + (unsigned int)a;
+	else if (in->op == OP_SUB)
+		r = (unsigned int)b - (unsigned int)a;
+	else if (in->op == OP_MUL)
+		r = (unsigned int)b * (unsigned int)a;
+	else if (ok && both)
+		r = in->op == OP_DIV ? b / a : b % a;
+	dce_pop(st, 1);
+	if (both && (ok || (in->op != OP_DIV && in->op != OP_MOD)))
+		st->known[0] = (int)r;
+	else
+		st->n_known = 0;
+	return (ok);
+}
+
+/**
+ * dce_index - Updates what is known of the stack across dup, over, pick,
+ * roll or drop.
+ * @st: What is known before the instruction.
+ * @in: The instruction.
+ *
+ * Return: 1 if the instruction is dead, else 0.
+ */
+int dce_index(dce_t *st, instr_t *in)
+{
+	size_t d = in->op == OP_DUP ? 0 : in->op == OP_OVER ? 1 :
+		(size_t)in->arg;
+	int ok, n;
+
+	if (in->op == OP_DROP)
+	{
+		ok = dce_need(st, d);
+		dce_pop(st, d);
+		return (ok);
+	}
+	ok = dce_need(st, d + 1);
+	if (in->op != OP_ROLL)
+		dce_push(st, d < (size_t)st->n_known,
+			 d < (size_t)st->n_known ? st->known[d] : 0);
+	else if (d < (size_t)st->n_known)
+	{
+		n = st->known[d];
+		memmove(st->known + 1, st->known, sizeof(int) * d);
+		st->known[0] = n;
+	}
+	else
+		st->n_known = 0;
+	return (ok);
+}
+
+/**
+ * dce_push - Records a push.
+ * @st: What is known of the stack.
+ * @is_known: Non-zero if the value is the constant @n.
+ * @n: The value.
+ *
+ * In queue mode the value goes to the bottom, below any value known.
+ */
+void dce_push(dce_t *st, int is_known, int n)
+{
+	st->depth++;
+	if (st->mode == QUEUE)
+		return;
+	if (st->mode != STACK || !is_known)
+	{
+		st->n_known = 0;
+		return;
+	}
+	memmove(st->known + 1, st->known, sizeof(int) * (DCE_KNOWN - 1));
+	st->known[0] = n;
+	if (st->n_known < DCE_KNOWN)
+		st->n_known++;
+}
+
+/**
+ * dce_pop - Records values leaving the top.
+ * @st: What is known of the stack, holding at least @n values.
+ * @n: Number of values.
+ */
+void dce_pop(dce_t *st, size_t n)
+{
+	st->depth -= n;
+	if (n >= (size_t)st->n_known)
+	{
+		st->n_known = 0;
+		return;
+	}
+	st->n_known -= n;
+	memmove(st->known, st->known + n, sizeof(int) * st->n_known);
+}
+
+/**
+ * dce_need - Checks that the stack holds enough values for an opcode.
+ * @st: What is known of the stack; past the opcode, it holds at least @n.
+ * @n: Number of values the opcode needs.
+ *
+ * Return: 1 if the stack is known to hold them, else 0.
+ */
+int dce_need(dce_t *st, size_t n)
+{
+	if (st->depth >= n)
+		return (1);
+	st->depth = n;
+	return (0);
+}
@@ -0,0 +1,203 @@
+#include "monty.h"
+#include <string.h>
+
+int stack_grow(stack_t *stack);
+int stack_push(stack_t *stack, int n);
+int stack_room(stack_t *stack);
+int stack_rotate(stack_t *stack, long k);
+int stack_push_n(stack_t *stack, const int *vals, size_t n);
+
+/**
+ * stack_grow - Doubles the capacity of a full stack_t ring buffer.
+ * @stack: The stack_t to grow.
+ *
+ * The buffer is realloc'ed, which remaps large buffers instead of
+ * copying them, so a deep stack never holds two copies of its values.
+ * If the values wrapped around the end of the old buffer, the shorter of
+ * the two runs is moved to keep them contiguous in the new one.
+ *
+ * Return: EXIT_FAILURE if malloc fails, STACK_LIMIT if the stacks would
+ * outgrow --max-memory, else EXIT_SUCCESS.
+ */
+int stack_grow(stack_t *stack)
+{
+	int *vals;
+	size_t first, rest;
+
+	if (opts.max_memory &&
+	    vm.mem + sizeof(int) * stack->cap > opts.max_memory)
+		return (STACK_LIMIT);
+	vals = realloc(stack->vals, sizeof(int) * stack->cap * 2);
+	if (vals == NULL)
+		return (EXIT_FAILURE);
+
+	first = stack->cap - stack->head;
+	rest = stack->len > first ? stack->len - first : 0;
+	if (rest > 0 && rest <= first)
+		memcpy(vals + stack->cap, vals, sizeof(int) * rest);
+	else if (rest > 0)
+	{
+		memcpy(vals + stack->head + stack->cap, vals + stack->head,
+		       sizeof(int) * first);
+		stack->head += stack->cap;
+	}
+	stack->vals = vals;
+	vm.mem += sizeof(int) * stack->cap;
+	stack->cap *= 2;
+
+	return (EXIT_SUCCESS);
+}
+
+/**
+ * stack_push - Adds a value at the end of a stack_t selected by its mode.
+ * @stack: The stack_t to push onto.
+ * @n: The value to push.
+ *
+ * In STACK mode the value becomes the new top, in QUEUE mode the new
+ * bottom; both are O(1) amortized.
+ *
+ * Return: EXIT_SUCCESS, EXIT_FAILURE if malloc fails, STACK_LIMIT past
+ * --max-depth or --max-memory, or STACK_IO if spilling failed.
+ */
+int stack_push(stack_t *stack, int n)
+{
+	int status, spilled = stack->spill != NULL && stack->spill->len > 0;
+
+	if (opts.max_depth && STACK_DEPTH(stack) >= opts.max_depth)
+		return (STACK_LIMIT);
+	if (stack->len == stack->cap && !(stack->mode == QUEUE && spilled))
+	{
+		status = stack_room(stack);
+		if (status != EXIT_SUCCESS)
+			return (status);
+		spilled = stack->spill != NULL && stack->spill->len > 0;
+	}
+	if (stack->mode == QUEUE && spilled)
+		return (spill_push(stack, n));
+
+	if (stack->mode == STACK)
+	{
+		stack->head = (stack->head - 1) & (stack->cap - 1);
+		stack->vals[stack->head] = n;
+	}
+	else
+	{
+		STACK_AT(stack, stack->len) = n;
+	}
+	stack->len++;
+
+	return (EXIT_SUCCESS);
+}
+
+/**
+ * stack_room - Makes room in a full stack_t ring buffer.
+ * @stack: The stack_t.
+ *
+ * With --spill, a ring buffer that would outgrow its share of
+ * --max-memory, or the memory left, has its bottom half paged out instead.
+ *
+ * Return: EXIT_SUCCESS, or the failure of stack_grow or spill_out.
+ */
+int stack_room(stack_t *stack)
+{
+	if (opts.spill && stack->cap >= 2 * SPILL_CHUNK &&
+	    (sizeof(int) * stack->cap * 2 > opts.max_memory / SPILL_SHARE ||
+	     vm.mem + sizeof(int) * stack->cap > opts.max_memory))
+		return (spill_out(stack));
+	return (stack_grow(stack));
+}
+
+/**
+ * stack_rotate - Rotates a stack_t towards its top by k positions.
+ * @stack: The stack_t to rotate.
+ * @k: Number of positions; positive moves the top to the bottom (rotl),
+ *     negative moves the bottom to the top (rotr).
+ *
+ * When the ring buffer is full a rotation is a pure head adjustment;
+ * otherwise min(k, len - k) values are carried across the free gap.
+ *
+ * Return: EXIT_SUCCESS, or the failure of spill_rotate.
+ */
+int stack_rotate(stack_t *stack, long k)
+{
+	size_t mask = stack->cap - 1, steps;
+
+	if (stack->spill && stack->spill->len > 0)
+		return (spill_rotate(stack, k));
+	if (stack->len < 2)
+		return (EXIT_SUCCESS);
+	k %= (long)stack->len;
+	if (k < 0)
+		k += stack->len;
+	if (k == 0)
+		return (EXIT_SUCCESS);
+	if (stack->len == stack->cap)
+	{
+		stack->head = (stack->head + k) & mask;
+		return (EXIT_SUCCESS);
+	}
+	if ((size_t)k <= stack->len / 2)
+	{
+		for (steps = k; steps > 0; steps--)
+		{
+			STACK_AT(stack, stack->len) = stack->vals[stack->head];
+			stack->head = (stack->head + 1) & mask;
+		}
+		return (EXIT_SUCCESS);
+	}
+	for (steps = stack->len - k; steps > 0; steps--)
+	{
+		stack->head = (stack->head - 1) & mask;
+		stack->vals[stack->head] = STACK_AT(stack, stack->len);
+	}
+	return (EXIT_SUCCESS);
+}
+
+/**
+ * stack_push_n - Pushes a run of values as if by stack_push on each.
+ * @stack: The stack_t to push onto.
+ * @vals: The values in the order they end up on a stack, top first.
+ * @n: Number of values.
+ *
+ * Without --max-depth or --spill the ring buffer grows once up front and,
+ * in STACK mode, the values land with at most two memcpy calls.
+ *
+ * Return: As stack_push.
+ */
+int stack_push_n(stack_t *stack, const int *vals, size_t n)
+{
+	size_t i, first;
+	int status;
+
+	if (opts.max_depth || opts.spill)
+	{
+		for (i = n; i > 0; i--)
+		{
+			status = stack_push(stack, vals[i - 1]);
+			if (status != EXIT_SUCCESS)
+				return (status);
+		}
+		return (EXIT_SUCCESS);
+	}
+	while (stack->cap - stack->len < n)
+	{
+		status = stack_grow(stack);
+		if (status != EXIT_SUCCESS)
+			return (status);
+	}
+	if (stack->mode == QUEUE)
+	{
+		for (i = 0; i < n; i++)
+			STACK_AT(stack, stack->len + i) = vals[n - 1 - i];
+	}
+	else
+	{
+		stack->head = (stack->head - n) & (stack->cap - 1);
+		first = stack->cap - stack->head;
+		first = first < n ? first : n;
+		memcpy(stack->vals + stack->head, vals, sizeof(int) * first);
+		memcpy(stack->vals, vals + first, sizeof(int) * (n - first));
+	}
+	stack->len += n;
+	return (EXIT_SUCCESS);
+}
@@ -0,0 +1,387 @@
+#include "monty.h"
+#include <string.h>
+
+/* EMIT_C_STR, EMIT_C_NUM - A numeric macro as a string literal */
+#define EMIT_C_STR(x) #x
+#define EMIT_C_NUM(x) EMIT_C_STR(x)
+
+int emit_c(prog_t *prog, FILE *out, int bf);
+void emit_c_prelude(FILE *out);
+void emit_c_str(FILE *out, char *str);
+void emit_c_check(FILE *out, char *cond, unsigned int line, char *what);
+void emit_c_bank(instr_t *in, FILE *out);
+
+/**
+ * emit_c - Writes a decoded program out as a standalone C program.
+ * @prog: The decoded program.
+ * @out: Where to write the C source.
+ * @bf: Non-zero for a Brainfuck program, whose stack starts as a full
+ * BF_TAPE-cell tape of zeroes.
+ *
+ * Description: Every instruction becomes the inlined statements of its
+ * opcode, working on a ring buffer held in the generated file, and jumps
+ * become gotos; ret jumps to a switch over the return addresses of the
+ * calls. The program prints the same output and error messages
+ * and exits with the same status as the interpreter would.
+ *
+ * Return: EXIT_SUCCESS, or EXIT_FAILURE if malloc fails.
+ */
+int emit_c(prog_t *prog, FILE *out, int bf)
+{
+	char *target;
+	size_t i;
+
+	target = calloc(prog->len + 1, 1);
+	if (target == NULL)
+		return (malloc_error());
+	for (i = 0; i < prog->len; i++)
+	{
+		if (op_table[prog->code[i].op].operand == OPND_LABEL ||
+		    prog->code[i].op == OP_DEF)
+			target[prog->code[i].arg] = 1;
+		if (prog->code[i].op == OP_CALL)
+			target[i + 1] = 1;
+	}
+
+	emit_c_prelude(out);
+	if (bf)
+		fprintf(out, "\tcap = %d;\n\tm = cap - 1;\n\tn = cap;\n",
+			BF_TAPE);
+	fprintf(out, "\tv = calloc(cap, sizeof(int));\n\tif (v == NULL)\n"
+		"\t\treturn (fail(\"Error: malloc failed\\n\"));\n");
+	for (i = 0; i < prog->len; i++)
+	{
+		if (target[i])
+			fprintf(out, "i%lu:\n", (unsigned long)i);
+		emit_c_instr(prog, &prog->code[i], out);
+	}
+	if (target[prog->len])
+		fprintf(out, "i%lu:\n", (unsigned long)prog->len);
+	if (prog->nul_tail)
+		fprintf(out, "\treturn (fail(\"Error: malloc failed\\n\"));\n");
+	fprintf(out, "\treturn (EXIT_SUCCESS);\n");
+	emit_c_returns(prog, out);
+	fprintf(out, "}\n");
+	free(target);
+	return (EXIT_SUCCESS);
+}
+
+/**
+ * emit_c_prelude - Writes the runtime the generated statements rely on.
+ * @out: Where to write the C source.
+ *
+ * The ring buffer and its helpers mirror stack_t, stack_push and
+ * stack_rotate, so rotations and queue mode behave the same. The other
+ * stacks of the bank are parked in an array; sel swaps one in. The map
+ * helpers probe and delete like map_slot and map_del.
+ */
+void emit_c_prelude(FILE *out)
+{
+	static const char * const prelude[] = {
+		"/* Generated by monty --emit-c */",
+		"#include <stdio.h>",
+		"#include <stdlib.h>",
+		"",
+		"static int *v;",
+		"static size_t h, n, cap = 16, m = 15;",
+		"static int mode;",
+		"static size_t rs[" EMIT_C_NUM(RET_DEPTH) "], rp;",
+		"",
+		"#define AT(i) v[(h + (i)) & m]",
+		"#define DROP() (h = (h + 1) & m, n--)",
+		"",
+		"static int fail(const char *msg)",
+		"{",
+		"\tfputs(msg, stderr);",
+		"\treturn (EXIT_FAILURE);",
+		"}",
+		"",
+		"static int push(int x)",
+		"{",
+		"\tint *nv;",
+		"\tsize_t i;",
+		"",
+		"\tif (n == cap)",
+		"\t{",
+		"\t\tnv = malloc(sizeof(int) * cap * 2);",
+		"\t\tif (nv == NULL)",
+		"\t\t\treturn (0);",
+		"\t\tfor (i = 0; i < n; i++)",
+		"\t\t\tnv[i] = AT(i);",
+		"\t\tfree(v);",
+		"\t\tv = nv;",
+		"\t\th = 0;",
+		"\t\tcap *= 2;",
+		"\t\tm = cap - 1;",
+		"\t}",
+		"\tif (mode == 0)",
+		"\t{",
+		"\t\th = (h - 1) & m;",
+		"\t\tv[h] = x;",
+		"\t}",
+		"\telse",
+		"\t\tAT(n) = x;",
+		"\tn++;",
+		"\treturn (1);",
+		"}",
+		"",
+		"static int rd(int *x)",
+		"{",
+		"\tunsigned int u = 0;",
+		"\tint c, neg;",
+		"",
+		"\tdo",
+		"\t\tc = getchar();",
+		"\twhile (c == ' ' || (c >= '\\t' && c <= '\\r'));",
+		"\tif (c == EOF)",
+		"\t\treturn (0);",
+		"\tneg = c == '-';",
+		"\tif (c == '-' || c == '+')",
+		"\t\tc = getchar();",
+		"\tif (c < '0' || c > '9')",
+		"\t\treturn (-1);",
+		"\tfor (; c >= '0' && c <= '9'; c = getchar())",
+		"\t\tu = u * 10 + (c - '0');",
+		"\tif (c != EOF && c != ' ' && (c < '\\t' || c > '\\r'))",
+		"\t\treturn (-1);",
+		"\t*x = (int)(neg ? 0 - u : u);",
+		"\treturn (1);",
+		"}",
+		"",
+		"static void rot(long k)",
+		"{",
+		"\tif (n < 2)",
+		"\t\treturn;",
+		"\tk %= (long)n;",
+		"\tif (k < 0)",
+		"\t\tk += n;",
+		"\tif (n == cap)",
+		"\t\th = (h + k) & m;",
+		"\telse if ((size_t)k <= n / 2)",
+		"\t\tfor (; k > 0; k--)",
+		"\t\t{",
+		"\t\t\tAT(n) = v[h];",
+		"\t\t\th = (h + 1) & m;",
+		"\t\t}",
+		"\telse",
+		"\t\tfor (k = n - k; k > 0; k--)",
+		"\t\t{",
+		"\t\t\th = (h - 1) & m;",
+		"\t\t\tv[h] = AT(n);",
+		"\t\t}",
+		"}",
+		"",
+		"typedef struct bank_s",
+		"{",
+		"\tint *v;",
+		"\tsize_t h, n, cap, m;",
+		"\tint mode;",
+		"} bank_t;",
+		"",
+		"static bank_t bank[16];",
+		"static int cur;",
+		"",
+		"static int sel(int k)",
+		"{",
+		"\tbank[cur].v = v;",
+		"\tbank[cur].h = h;",
+		"\tbank[cur].n = n;",
+		"\tbank[cur].cap = cap;",
+		"\tbank[cur].m = m;",
+		"\tbank[cur].mode = mode;",
+		"\tcur = k;",
+		"\tif (bank[k].v == NULL)",
+		"\t{",
+		"\t\tbank[k].cap = 16;",
+		"\t\tbank[k].m = 15;",
+		"\t\tbank[k].v = malloc(sizeof(int) * 16);",
+		"\t\tif (bank[k].v == NULL)",
+		"\t\t\treturn (0);",
+		"\t}",
+		"\tv = bank[k].v;",
+		"\th = bank[k].h;",
+		"\tn = bank[k].n;",
+		"\tcap = bank[k].cap;",
+		"\tm = bank[k].m;",
+		"\tmode = bank[k].mode;",
+		"\treturn (1);",
+		"}",
+		"",
+		"typedef struct slot_s",
+		"{",
+		"\tint k, v;",
+		"} slot_t;",
+		"",
+		"static slot_t *mt;",
+		"static size_t mcap, mlen;",
+		"static int mhas, mval;",
+		"",
+		"#define MEMPTY (-2147483647 - 1)",
+		"#define MH(k) ((((unsigned int)(k) * 0x9e3779b1U) ^ \\",
+		"\t((unsigned int)(k) >> 16)) & (mcap - 1))",
+		"#define MNEXT(i) (((i) + 1) & (mcap - 1))",
+		"",
+		"static int *mget(int k)",
+		"{",
+		"\tsize_t i;",
+		"",
+		"\tif (k == MEMPTY)",
+		"\t\treturn (mhas ? &mval : NULL);",
+		"\tif (mlen == 0)",
+		"\t\treturn (NULL);",
+		"\tfor (i = MH(k); mt[i].k != k; i = MNEXT(i))",
+		"\t\tif (mt[i].k == MEMPTY)",
+		"\t\t\treturn (NULL);",
+		"\treturn (&mt[i].v);",
+		"}",
+		"",
+		"static int mput(int k, int x)",
+		"{",
+		"\tslot_t *old = mt;",
+		"\tsize_t i, j, oc = mcap;",
+		"",
+		"\tif (k == MEMPTY)",
+		"\t{",
+		"\t\tmhas = 1;",
+		"\t\tmval = x;",
+		"\t\treturn (1);",
+		"\t}",
+		"\tif (4 * (mlen + 1) > 3 * mcap)",
+		"\t{",
+		"\t\tmcap = mcap ? mcap * 2 : 16;",
+		"\t\tmt = malloc(sizeof(slot_t) * mcap);",
+		"\t\tif (mt == NULL)",
+		"\t\t\treturn (0);",
+		"\t\tfor (i = 0; i < mcap; i++)",
+		"\t\t\tmt[i].k = MEMPTY;",
+		"\t\tfor (j = 0; j < oc; j++)",
+		"\t\t{",
+		"\t\t\tif (old[j].k == MEMPTY)",
+		"\t\t\t\tcontinue;",
+		"\t\t\tfor (i = MH(old[j].k); mt[i].k != MEMPTY; i = MNEXT(i))",
+		"\t\t\t\t;",
+		"\t\t\tmt[i] = old[j];",
+		"\t\t}",
+		"\t\tfree(old);",
+		"\t}",
+		"\tfor (i = MH(k); mt[i].k != MEMPTY && mt[i].k != k; "
+		"i = MNEXT(i))",
+		"\t\t;",
+		"\tmlen += mt[i].k == MEMPTY;",
+		"\tmt[i].k = k;",
+		"\tmt[i].v = x;",
+		"\treturn (1);",
+		"}",
+		"",
+		"static void mdel(int k)",
+		"{",
+		"\tsize_t i, j, d;",
+		"",
+		"\tif (k == MEMPTY)",
+		"\t\tmhas = 0;",
+		"\tif (k == MEMPTY || mget(k) == NULL)",
+		"\t\treturn;",
+		"\tfor (i = MH(k); mt[i].k != k; i = MNEXT(i))",
+		"\t\t;",
+		"\tfor (j = MNEXT(i); mt[j].k != MEMPTY; j = MNEXT(j))",
+		"\t{",
+		"\t\td = (j - MH(mt[j].k)) & (mcap - 1);",
+		"\t\tif (d >= ((j - i) & (mcap - 1)))",
+		"\t\t{",
+		"\t\t\tmt[i] = mt[j];",
+		"\t\t\ti = j;",
+		"\t\t}",
+		"\t}",
+		"\tmt[i].k = MEMPTY;",
+		"\tmlen--;",
+		"}",
+		"",
+		"int main(void)",
+		"{",
+		"\tsize_t i;",
+		"\tint c;",
+		"",
+		"\t(void)i;",
+		"\t(void)c;",
+		"\t(void)push;",
+		"\t(void)rot;",
+		"\t(void)sel;",
+		"\t(void)rs;",
+		"\t(void)rp;",
+		"\t(void)rd;",
+		"\t(void)mput;",
+		"\t(void)mdel;",
+		NULL
+	};
+	size_t i;
+
+	for (i = 0; prelude[i]; i++)
+		fprintf(out, "%s\n", prelude[i]);
+}
+
+/**
+ * emit_c_str - Writes a string as the body of a C string literal.
+ * @out: Where to write the C source.
+ * @str: The string; anything but plain printable ASCII is escaped.
+ */
+void emit_c_str(FILE *out, char *str)
+{
+	unsigned char *s = (unsigned char *)str;
+
+	for (; *s; s++)
+	{
+		if (*s == '"' || *s == '\\' || *s == '?')
+			fprintf(out, "\\%c", *s);
+		else if (*s < 32 || *s > 126)
+			fprintf(out, "\\%03o", *s);
+		else
+			fputc(*s, out);
+	}
+}
+
+/**
+ * emit_c_check - Writes a check that fails with an L<n>: error message.
+ * @out: Where to write the C source.
+ * @cond: The C condition under which the opcode fails.
+ * @line: The line number for the message.
+ * @what: The message after "L<n>: ", without the newline.
+ */
+void emit_c_check(FILE *out, char *cond, unsigned int line, char *what)
+{
+	fprintf(out, "\tif (%s)\n\t\treturn (fail(\"L%u: ", cond, line);
+	emit_c_str(out, what);
+	fprintf(out, "\\n\"));\n");
+}
+
+/**
+ * emit_c_bank - Writes select, movto or movfrom.
+ * @in: The instruction.
+ * @out: Where to write the C source.
+ */
+void emit_c_bank(instr_t *in, FILE *out)
+{
+	if (in->op == OP_SELECT)
+	{
+		fprintf(out, "\tif (!sel(%d))\n\t\treturn (fail(\"Error: "
+			"malloc failed\\n\"));\n", in->arg);
+		return;
+	}
+	fprintf(out, "\ti = cur;\n");
+	if (in->op == OP_MOVTO)
+	{
+		emit_c_check(out, "n == 0", in->line,
+			     "can't movto, stack empty");
+		fprintf(out, "\tc = AT(0);\n\tDROP();\n\tif (!sel(%d) || "
+			"!push(c) || !sel((int)i))\n", in->arg);
+	}
+	else
+	{
+		fprintf(out, "\tif (!sel(%d))\n\t\treturn (fail(\"Error: "
+			"malloc failed\\n\"));\n", in->arg);
+		emit_c_check(out, "n == 0", in->line,
+			     "can't movfrom, stack empty");
+		fprintf(out, "\tc = AT(0);\n\tDROP();\n\tif (!sel((int)i) || "
+			"!push(c))\n");
+	}
+	fprintf(out, "\t\treturn (fail(\"Error: malloc failed\\n\"));\n");
+}
@@ -0,0 +1,185 @@
+#include "monty.h"
+
+void emit_c_instr(prog_t *prog, instr_t *in, FILE *out);
+void emit_c_math(instr_t *in, FILE *out);
+void emit_c_print(instr_t *in, FILE *out);
+void emit_c_jump(instr_t *in, FILE *out);
+void emit_c_bf(instr_t *in, FILE *out);
+
+/**
+ * emit_c_instr - Writes the C statements of one instruction.
+ * @prog: The decoded program.
+ * @in: The instruction.
+ * @out: Where to write the C source.
+ */
+void emit_c_instr(prog_t *prog, instr_t *in, FILE *out)
+{
+	switch (in->op)
+	{
+	case OP_PUSH:
+		fprintf(out, "\tif (!push(%d))\n\t\treturn (fail(\"Error: "
+			"malloc failed\\n\"));\n", in->arg);
+		break;
+	case OP_POP:
+		emit_c_check(out, "n == 0", in->line,
+			     "can't pop an empty stack");
+		fprintf(out, "\tDROP();\n");
+		break;
+	case OP_ROTL: case OP_ROTR: case OP_ROTN:
+		fprintf(out, "\trot(%ldL);\n", in->op == OP_ROTL ? 1L :
+			in->op == OP_ROTR ? -1L : (long)in->arg);
+		break;
+	case OP_STACK: case OP_QUEUE:
+		fprintf(out, "\tmode = %d;\n",
+			in->op == OP_STACK ? STACK : QUEUE);
+		break;
+	case OP_BAD_OP:
+		fprintf(out, "\treturn (fail(\"L%u: unknown instruction ",
+			in->line);
+		emit_c_str(out, prog->names[in->arg]);
+		fprintf(out, "\\n\"));\n");
+		break;
+	case OP_BAD_ARG:
+		fprintf(out, "\treturn (fail(\"L%u: usage: %s ", in->line,
+			op_table[in->arg].opcode);
+		emit_c_str(out, OPND_USAGE(in->arg));
+		fprintf(out, "\\n\"));\n");
+		break;
+	case OP_SELECT: case OP_MOVTO: case OP_MOVFROM:
+		emit_c_bank(in, out);
+		break;
+	case OP_DEF: case OP_END: case OP_CALL: case OP_RET:
+		emit_c_call(prog, in, out);
+		break;
+	case OP_PUSHS: case OP_PUSHN:
+		emit_c_pool(prog, in, out);
+		break;
+	case OP_DUP: case OP_OVER: case OP_PICK: case OP_ROLL: case OP_DROP:
+		emit_c_index(in, out);
+		break;
+	case OP_READ: case OP_READALL:
+		emit_c_read(in, out);
+		break;
+	case OP_LOAD: case OP_SAVE:
+		emit_c_file(prog, in, out);
+		break;
+	case OP_STORE: case OP_FETCH: case OP_HAS: case OP_DEL:
+		emit_c_map(in, out);
+		break;
+	case OP_NOP:
+		break;
+	default:
+		if (in->op >= OP_BF_ADD)
+			emit_c_bf(in, out);
+		else if (op_table[in->op].operand == OPND_LABEL)
+			emit_c_jump(in, out);
+		else if (in->op >= OP_SWAP && in->op <= OP_MOD)
+			emit_c_math(in, out);
+		else
+			emit_c_print(in, out);
+	}
+}
+
+/**
+ * emit_c_math - Writes swap, add, sub, mul, div or mod.
+ * @in: The instruction.
+ * @out: Where to write the C source.
+ */
+void emit_c_math(instr_t *in, FILE *out)
+{
+	char what[32];
+
+	sprintf(what, "can't %s, stack too short", op_table[in->op].opcode);
+	emit_c_check(out, "n < 2", in->line, what);
+	if (in->op == OP_SWAP)
+	{
+		fprintf(out, "\tc = AT(0);\n\tAT(0) = AT(1);\n\tAT(1) = c;\n");
+		return;
+	}
+	if (in->op == OP_DIV || in->op == OP_MOD)
+		emit_c_check(out, "AT(0) == 0", in->line, "division by zero");
+	fprintf(out, "\tAT(1) %s= AT(0);\n\tDROP();\n",
+		in->op == OP_ADD ? "+" : in->op == OP_SUB ? "-" :
+		in->op == OP_MUL ? "*" : in->op == OP_DIV ? "/" : "%");
+}
+
+/**
+ * emit_c_print - Writes pall, pint, pchar or pstr.
+ * @in: The instruction.
+ * @out: Where to write the C source.
+ */
+void emit_c_print(instr_t *in, FILE *out)
+{
+	if (in->op == OP_PALL)
+	{
+		fprintf(out, "\tfor (i = 0; i < n; i++)\n"
+			"\t\tprintf(\"%%d\\n\", AT(i));\n");
+	}
+	else if (in->op == OP_PINT)
+	{
+		emit_c_check(out, "n == 0", in->line,
+			     "can't pint, stack empty");
+		fprintf(out, "\tprintf(\"%%d\\n\", AT(0));\n");
+	}
+	else if (in->op == OP_PCHAR)
+	{
+		emit_c_check(out, "n == 0", in->line,
+			     "can't pchar, stack empty");
+		emit_c_check(out, "AT(0) < 0 || AT(0) > 127", in->line,
+			     "can't pchar, value out of range");
+		fprintf(out, "\tprintf(\"%%c\\n\", AT(0));\n");
+	}
+	else
+	{
+		fprintf(out, "\tfor (i = 0; i < n && AT(i) > 0 && AT(i) <= 127;"
+			" i++)\n\t\tprintf(\"%%c\", AT(i));\n"
+			"\tprintf(\"\\n\");\n");
+	}
+}
+
+/**
+ * emit_c_jump - Writes jmp, jz, jnz or loop as a goto.
+ * @in: The instruction; its operand is the target instruction index.
+ * @out: Where to write the C source.
+ */
+void emit_c_jump(instr_t *in, FILE *out)
+{
+	char what[32];
+
+	if (in->op == OP_JMP)
+	{
+		fprintf(out, "\tgoto i%d;\n", in->arg);
+		return;
+	}
+	sprintf(what, "can't %s, stack empty", op_table[in->op].opcode);
+	emit_c_check(out, "n == 0", in->line, what);
+	if (in->op == OP_LOOP)
+		fprintf(out, "\tif (--AT(0) > 0)\n\t\tgoto i%d;\n\tDROP();\n",
+			in->arg);
+	else
+		fprintf(out, "\tif (AT(0) %s 0)\n\t\tgoto i%d;\n",
+			in->op == OP_JZ ? "==" : "!=", in->arg);
+}
+
+/**
+ * emit_c_bf - Writes the Brainfuck opcodes.
+ * @in: The instruction.
+ * @out: Where to write the C source.
+ */
+void emit_c_bf(instr_t *in, FILE *out)
+{
+	int factor = in->arg & 0xff;
+
+	if (in->op == OP_BF_ADD)
+		fprintf(out, "\tAT(0) = (AT(0) + %d) & 0xff;\n", in->arg);
+	else if (in->op == OP_BF_OUT)
+		fprintf(out, "\tputchar(AT(0));\n");
+	else if (in->op == OP_BF_IN)
+		fprintf(out, "\tc = getchar();\n\tAT(0) = c == EOF ? 0 : c;\n");
+	else if (in->op == OP_BF_CLEAR)
+		fprintf(out, "\tAT(0) = 0;\n");
+	else
+		fprintf(out, "\tAT(%d) = (AT(%d) + AT(0) * %d) & 0xff;\n",
+			(in->arg - factor) / 256, (in->arg - factor) / 256,
+			factor);
+}
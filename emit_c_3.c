@@ -0,0 +1,136 @@
+#include "monty.h"
+
+void emit_c_call(prog_t *prog, instr_t *in, FILE *out);
+void emit_c_returns(prog_t *prog, FILE *out);
+void emit_c_pool(prog_t *prog, instr_t *in, FILE *out);
+void emit_c_index(instr_t *in, FILE *out);
+void emit_c_read(instr_t *in, FILE *out);
+
+/**
+ * emit_c_call - Writes def, end, call or ret.
+ * @prog: The decoded program.
+ * @in: The instruction.
+ * @out: Where to write the C source.
+ *
+ * A call saves the index of the next instruction, which emit_c_returns
+ * turns back into a goto.
+ */
+void emit_c_call(prog_t *prog, instr_t *in, FILE *out)
+{
+	char cond[32], what[40];
+
+	if (in->op == OP_DEF)
+	{
+		fprintf(out, "\tgoto i%d;\n", in->arg);
+		return;
+	}
+	if (in->op == OP_CALL)
+	{
+		sprintf(cond, "rp == %d", RET_DEPTH);
+		emit_c_check(out, cond, in->line,
+			     "can't call, return stack full");
+		fprintf(out, "\trs[rp++] = %lu;\n\tgoto i%d;\n",
+			(unsigned long)(in - prog->code) + 1, in->arg);
+		return;
+	}
+	sprintf(what, "can't %s, return stack empty", op_table[in->op].opcode);
+	emit_c_check(out, "rp == 0", in->line, what);
+	fprintf(out, "\tgoto ret;\n");
+}
+
+/**
+ * emit_c_returns - Writes the switch that ret and end jump to.
+ * @prog: The decoded program.
+ * @out: Where to write the C source, after the end of the program.
+ */
+void emit_c_returns(prog_t *prog, FILE *out)
+{
+	size_t i;
+
+	for (i = 0; i < prog->len; i++)
+		if (prog->code[i].op == OP_RET || prog->code[i].op == OP_END)
+			break;
+	if (i == prog->len)
+		return;
+	fprintf(out, "ret:\n\tswitch (rs[--rp])\n\t{\n");
+	for (i = 0; i < prog->len; i++)
+		if (prog->code[i].op == OP_CALL)
+			fprintf(out, "\tcase %lu:\n\t\tgoto i%lu;\n",
+				(unsigned long)i + 1, (unsigned long)i + 1);
+	fprintf(out, "\t}\n\treturn (EXIT_SUCCESS);\n");
+}
+
+/**
+ * emit_c_pool - Writes pushs or pushn.
+ * @prog: The decoded program.
+ * @in: The instruction.
+ * @out: Where to write the C source.
+ *
+ * The literal becomes a static array, pushed from its last value so that
+ * the first one ends up on top.
+ */
+void emit_c_pool(prog_t *prog, instr_t *in, FILE *out)
+{
+	int *lit = prog->pool + in->arg;
+	int i;
+
+	if (lit[0] == 0)
+		return;
+	fprintf(out, "\t{\n\t\tstatic const int k[] = {");
+	for (i = 1; i <= lit[0]; i++)
+		fprintf(out, "%s%d", i == 1 ? "" :
+			i % 12 == 1 ? ",\n\t\t\t" : ", ", lit[i]);
+	fprintf(out, "};\n\t\tsize_t j;\n\n\t\tfor (j = %d; j > 0; j--)\n"
+		"\t\t\tif (!push(k[j - 1]))\n\t\t\t\treturn (fail(\"Error: "
+		"malloc failed\\n\"));\n\t}\n", lit[0]);
+}
+
+/**
+ * emit_c_index - Writes dup, over, pick, roll or drop.
+ * @in: The instruction.
+ * @out: Where to write the C source.
+ */
+void emit_c_index(instr_t *in, FILE *out)
+{
+	unsigned long depth = in->op == OP_DUP ? 0 : in->op == OP_OVER ? 1 :
+		(unsigned long)in->arg;
+	char cond[48], what[40];
+
+	sprintf(cond, "n < %luUL", depth + (in->op != OP_DROP));
+	sprintf(what, "can't %s, stack too short", op_table[in->op].opcode);
+	emit_c_check(out, cond, in->line, what);
+	if (in->op == OP_DROP)
+		fprintf(out, "\th = (h + %luUL) & m;\n\tn -= %luUL;\n", depth,
+			depth);
+	else if (in->op == OP_ROLL)
+		fprintf(out, "\tc = AT(%luUL);\n\tfor (i = %luUL; i > 0; i--)\n"
+			"\t\tAT(i) = AT(i - 1);\n\tAT(0) = c;\n", depth, depth);
+	else
+		fprintf(out, "\tif (!push(AT(%luUL)))\n\t\treturn "
+			"(fail(\"Error: malloc failed\\n\"));\n", depth);
+}
+
+/**
+ * emit_c_read - Writes read or readall.
+ * @in: The instruction.
+ * @out: Where to write the C source.
+ *
+ * The generated rd parses stdin through getchar, with the same rules as
+ * input_int.
+ */
+void emit_c_read(instr_t *in, FILE *out)
+{
+	char *op = op_table[in->op].opcode;
+
+	fprintf(out, "\t{\n\t\tint x;\n\n");
+	if (in->op == OP_READ)
+		fprintf(out, "\t\tc = rd(&x);\n\t\tif (c == 0)\n\t\t\treturn "
+			"(fail(\"L%u: can't read, end of input\\n\"));\n"
+			"\t\tif (c > 0 && !push(x))\n", in->line);
+	else
+		fprintf(out, "\t\twhile ((c = rd(&x)) > 0)\n"
+			"\t\t\tif (!push(x))\n");
+	fprintf(out, "\t\t\treturn (fail(\"Error: malloc failed\\n\"));\n"
+		"\t\tif (c < 0)\n\t\t\treturn (fail(\"L%u: can't %s, "
+		"not an integer\\n\"));\n\t}\n", in->line, op);
+}
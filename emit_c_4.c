@@ -0,0 +1,102 @@
+#include "monty.h"
+#include <string.h>
+
+void emit_c_file(prog_t *prog, instr_t *in, FILE *out);
+void emit_c_check2(FILE *out, char *cond, unsigned int line, char *what);
+void emit_c_map(instr_t *in, FILE *out);
+
+/**
+ * emit_c_file - Writes load or save.
+ * @prog: The decoded program.
+ * @in: The instruction.
+ * @out: Where to write the C source.
+ *
+ * The generated code goes through stdio a byte at a time, which keeps it
+ * independent of the host's byte order.
+ */
+void emit_c_file(prog_t *prog, instr_t *in, FILE *out)
+{
+	char *path = prog->names[in->arg], *what;
+
+	what = malloc(strlen(path) + 16);
+	if (what == NULL)
+		return;
+	sprintf(what, "can't %s %s", op_table[in->op].opcode, path);
+	fprintf(out, "\t{\n\t\tFILE *f = fopen(\"");
+	emit_c_str(out, path);
+	if (in->op == OP_LOAD)
+	{
+		fprintf(out, "\", \"rb\");\n"
+			"\t\tunsigned char b[4];\n"
+			"\t\tlong len = -1;\n\n"
+			"\t\tif (f != NULL && fseek(f, 0, SEEK_END) == 0)\n"
+			"\t\t\tlen = ftell(f);\n");
+		emit_c_check2(out, "len < 0 || len % 4 != 0 || "
+			      "fseek(f, 0, SEEK_SET) != 0", in->line, what);
+		fprintf(out, "\t\twhile (fread(b, 1, 4, f) == 4)\n"
+			"\t\t\tif (!push((int)(b[0] | "
+			"(unsigned int)b[1] << 8 |\n"
+			"\t\t\t    (unsigned int)b[2] << 16 | "
+			"(unsigned int)b[3] << 24)))\n"
+			"\t\t\t\treturn (fail(\"Error: malloc failed\\n\"));\n"
+			"\t\tfclose(f);\n");
+	}
+	else
+	{
+		fprintf(out, "\", \"wb\");\n\n");
+		emit_c_check2(out, "f == NULL", in->line, what);
+		fprintf(out, "\t\tfor (i = 0; i < n; i++)\n\t\t{\n"
+			"\t\t\tc = mode ? AT(i) : AT(n - 1 - i);\n"
+			"\t\t\tputc(c & 0xff, f);\n"
+			"\t\t\tputc(c >> 8 & 0xff, f);\n"
+			"\t\t\tputc(c >> 16 & 0xff, f);\n"
+			"\t\t\tputc(c >> 24 & 0xff, f);\n\t\t}\n");
+		emit_c_check2(out, "fclose(f) != 0", in->line, what);
+	}
+	fprintf(out, "\t}\n");
+	free(what);
+}
+
+/**
+ * emit_c_check2 - Writes a check like emit_c_check, one block deeper.
+ * @out: Where to write the C source.
+ * @cond: The C condition under which the opcode fails.
+ * @line: The line number for the message.
+ * @what: The message after "L<n>: ", without the newline.
+ */
+void emit_c_check2(FILE *out, char *cond, unsigned int line, char *what)
+{
+	fprintf(out, "\t\tif (%s)\n\t\t\treturn (fail(\"L%u: ", cond, line);
+	emit_c_str(out, what);
+	fprintf(out, "\\n\"));\n");
+}
+
+/**
+ * emit_c_map - Writes store, fetch, has or del.
+ * @in: The instruction.
+ * @out: Where to write the C source.
+ */
+void emit_c_map(instr_t *in, FILE *out)
+{
+	char *op = op_table[in->op].opcode, what[40];
+
+	if (in->op == OP_STORE)
+	{
+		emit_c_check(out, "n < 2", in->line,
+			     "can't store, stack too short");
+		fprintf(out, "\tif (!mput(AT(0), AT(1)))\n\t\treturn (fail(\""
+			"Error: malloc failed\\n\"));\n\th = (h + 2) & m;\n"
+			"\tn -= 2;\n");
+		return;
+	}
+	sprintf(what, "can't %s, stack empty", op);
+	emit_c_check(out, "n == 0", in->line, what);
+	if (in->op == OP_FETCH)
+		fprintf(out, "\t{\n\t\tint *p = mget(AT(0));\n\n\t\tif (p == "
+			"NULL)\n\t\t\treturn (fail(\"L%u: can't fetch, key not "
+			"found\\n\"));\n\t\tAT(0) = *p;\n\t}\n", in->line);
+	else if (in->op == OP_HAS)
+		fprintf(out, "\tAT(0) = mget(AT(0)) != NULL;\n");
+	else
+		fprintf(out, "\tmdel(AT(0));\n\tDROP();\n");
+}
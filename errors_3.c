@@ -0,0 +1,78 @@
+#include "monty.h"
+
+int arg_error(unsigned int line_number, char *op, char *kind);
+int empty_stack_error(unsigned int line_number, char *op);
+int label_error(unsigned int line_number, char *message, char *label);
+int sock_error(char *path);
+int resume_error(char *path);
+
+/**
+ * arg_error - Reports a missing or malformed operand.
+ * @line_number: The line number in the Monty bytecode file where the
+ *               error occurred.
+ * @op: The opcode that expected an operand.
+ * @kind: What the operand should have been ("integer", "label", ...).
+ *
+ * This is the general form of no_int_error for opcodes other than push.
+ *
+ * Return: Always returns EXIT_FAILURE to indicate an error condition.
+ */
+int arg_error(unsigned int line_number, char *op, char *kind)
+{
+	fprintf(stderr, "L%u: usage: %s %s\n", line_number, op, kind);
+	return (EXIT_FAILURE);
+}
+
+/**
+ * empty_stack_error - Reports an opcode that needs a value on an empty
+ *                     stack, in the same words as pint_error.
+ * @line_number: The line number in the Monty bytecode file where the
+ *               error occurred.
+ * @op: The opcode that found the stack empty.
+ *
+ * Return: Always returns EXIT_FAILURE to indicate an error condition.
+ */
+int empty_stack_error(unsigned int line_number, char *op)
+{
+	fprintf(stderr, "L%u: can't %s, stack empty\n", line_number, op);
+	return (EXIT_FAILURE);
+}
+
+/**
+ * label_error - Reports a label that cannot be resolved.
+ * @line_number: The line number in the Monty bytecode file where the
+ *               error occurred.
+ * @message: What is wrong with the label.
+ * @label: The label name.
+ *
+ * Return: Always returns EXIT_FAILURE to indicate an error condition.
+ */
+int label_error(unsigned int line_number, char *message, char *label)
+{
+	fprintf(stderr, "L%u: %s %s\n", line_number, message, label);
+	return (EXIT_FAILURE);
+}
+
+/**
+ * sock_error - Reports a Unix socket that cannot be set up or reached.
+ * @path: The socket path.
+ *
+ * Return: Always returns EXIT_FAILURE to indicate an error condition.
+ */
+int sock_error(char *path)
+{
+	fprintf(stderr, "Error: Can't use socket %s\n", path);
+	return (EXIT_FAILURE);
+}
+
+/**
+ * resume_error - Reports a snapshot that cannot be resumed.
+ * @path: The snapshot path.
+ *
+ * Return: Always returns EXIT_FAILURE to indicate an error condition.
+ */
+int resume_error(char *path)
+{
+	fprintf(stderr, "Error: Can't resume from %s\n", path);
+	return (EXIT_FAILURE);
+}
@@ -0,0 +1,84 @@
+#include "monty.h"
+
+int write_error(char *filename);
+int limit_error(int status, unsigned int line_number, char *opcode);
+int call_error(unsigned int line_number, char *op, char *message);
+int file_error(int status, unsigned int line_number, char *op, char *path);
+int key_error(unsigned int line_number, char *op);
+
+/**
+ * write_error - Reports a file that could not be written.
+ * @filename: The file.
+ *
+ * Return: Always returns EXIT_FAILURE to indicate an error condition.
+ */
+int write_error(char *filename)
+{
+	fprintf(stderr, "Error: Can't write file %s\n", filename);
+	return (EXIT_FAILURE);
+}
+
+/**
+ * limit_error - Reports an opcode that could not grow a stack.
+ * @status: What stack_push or a spill function returned.
+ * @line_number: Line number of the opcode.
+ * @opcode: The opcode.
+ *
+ * Return: Always returns EXIT_FAILURE to indicate an error condition.
+ */
+int limit_error(int status, unsigned int line_number, char *opcode)
+{
+	if (status == STACK_LIMIT)
+		fprintf(stderr, "L%u: can't %s, stack limit reached\n",
+			line_number, opcode);
+	else if (status == STACK_IO)
+		fprintf(stderr, "L%u: can't %s, spill file failed\n",
+			line_number, opcode);
+	else
+		return (malloc_error());
+	return (EXIT_FAILURE);
+}
+
+/**
+ * call_error - Reports a call or return the return stack can't take.
+ * @line_number: Line number of the opcode.
+ * @op: The opcode.
+ * @message: What is wrong with the return stack.
+ *
+ * Return: Always returns EXIT_FAILURE to indicate an error condition.
+ */
+int call_error(unsigned int line_number, char *op, char *message)
+{
+	fprintf(stderr, "L%u: can't %s, %s\n", line_number, op, message);
+	return (EXIT_FAILURE);
+}
+
+/**
+ * file_error - Reports a file that load or save could not use.
+ * @status: EXIT_FAILURE if malloc failed, else anything else.
+ * @line_number: Line number of the opcode.
+ * @op: The opcode.
+ * @path: The file.
+ *
+ * Return: Always returns EXIT_FAILURE to indicate an error condition.
+ */
+int file_error(int status, unsigned int line_number, char *op, char *path)
+{
+	if (status == EXIT_FAILURE)
+		return (malloc_error());
+	fprintf(stderr, "L%u: can't %s %s\n", line_number, op, path);
+	return (EXIT_FAILURE);
+}
+
+/**
+ * key_error - Reports a key that is not in the map.
+ * @line_number: Line number of the opcode.
+ * @op: The opcode.
+ *
+ * Return: Always returns EXIT_FAILURE to indicate an error condition.
+ */
+int key_error(unsigned int line_number, char *op)
+{
+	fprintf(stderr, "L%u: can't %s, key not found\n", line_number, op);
+	return (EXIT_FAILURE);
+}
@@ -0,0 +1,27 @@
+#include "monty.h"
+
+int timeout_error(void);
+int chdir_error(void);
+
+/**
+ * timeout_error - Reports a daemon job stopped after --timeout seconds.
+ *
+ * Return: Always returns EXIT_FAILURE to indicate an error condition.
+ */
+int timeout_error(void)
+{
+	fprintf(stderr, SERVE_TIMEOUT_MSG, opts.timeout);
+	return (EXIT_FAILURE);
+}
+
+/**
+ * chdir_error - Reports a daemon job whose client's working directory
+ * the worker cannot enter.
+ *
+ * Return: Always returns EXIT_FAILURE to indicate an error condition.
+ */
+int chdir_error(void)
+{
+	fprintf(stderr, "Error: Can't enter the client's working directory\n");
+	return (EXIT_FAILURE);
+}
@@ -7,8 +7,8 @@ void monty_pop(stack_t **stack, unsigned int line_number);
 void monty_swap(stack_t **stack, unsigned int line_number);
 
 /**
- * monty_push - Shoves a value onto the summit of a stack_t
- * cascading collection.
+ * monty_push - Shoves a value onto the summit (or, in queue mode, the
+ * base) of a stack_t cascading collection.
  * @stack: A pointer to the uppermost layer
  * node in a stack_t cascading collection.
  * @line_number: The current assembly instruction
@@ -17,69 +17,30 @@ void monty_swap(stack_t **stack, unsigned int line_number);
 
 void monty_push(stack_t **stack, unsigned int line_number)
 {
-	stack_t *tmp, *new;
-	int i;
+	int status = stack_push(*stack, vm.arg);
 
-	new = malloc(sizeof(stack_t));
-	if (new == NULL)
-	{
-		set_op_tok_error(malloc_error());
-		return;
-	}
-
-	if (op_toks[1] == NULL)
-	{
-		set_op_tok_error(no_int_error(line_number));
-		return;
-	}
-
-	for (i = 0; op_toks[1][i]; i++)
-	{
-		if (op_toks[1][i] == '-' && i == 0)
-			continue;
-		if (op_toks[1][i] < '0' || op_toks[1][i] > '9')
-		{
-			set_op_tok_error(no_int_error(line_number));
-			return;
-		}
-	}
-	new->n = atoi(op_toks[1]);
-
-	if (check_mode(*stack) == STACK)
-	{
-		tmp = (*stack)->next;
-		new->prev = *stack;
-		new->next = tmp;
-		if (tmp)
-			tmp->prev = new;
-		(*stack)->next = new;
-	}
-	else
-	{
-		tmp = *stack;
-		while (tmp->next)
-			tmp = tmp->next;
-		new->prev = tmp;
-		new->next = NULL;
-		tmp->next = new;
-	}
+	if (status != EXIT_SUCCESS)
+		set_op_error(limit_error(status, line_number, "push"));
 }
 
 /**
- * monty_pall - Echoes the contents of a stack_t linked list.
+ * monty_pall - Echoes the contents of a stack_t from top to bottom.
  * @stack: A reference to the uppermost element of a stack_t linked list.
  * @line_number: Current line number in a Monty bytecode file.
  */
 void monty_pall(stack_t **stack, unsigned int line_number)
 {
-	stack_t *tmp = (*stack)->next;
+	size_t i;
 
-	while (tmp)
+	if ((*stack)->spill != NULL)
 	{
-		printf("%d\n", tmp->n);
-		tmp = tmp->next;
+		if (spill_print(*stack, 0) != EXIT_SUCCESS)
+			set_op_error(limit_error(STACK_IO, line_number,
+						 "pall"));
+		return;
 	}
-	(void)line_number;
+	for (i = 0; i < (*stack)->len; i++)
+		printf("%d\n", STACK_AT(*stack, i));
 }
 
 /**
@@ -89,18 +50,18 @@ void monty_pall(stack_t **stack, unsigned int line_number)
  */
 void monty_pint(stack_t **stack, unsigned int line_number)
 {
-	if ((*stack)->next == NULL)
+	if ((*stack)->len == 0)
 	{
-		set_op_tok_error(pint_error(line_number));
+		set_op_error(pint_error(line_number));
 		return;
 	}
 
-	printf("%d\n", (*stack)->next->n);
+	printf("%d\n", STACK_AT(*stack, 0));
 }
 
 
 /**
- * monty_pop - Disposes of the uppermost element in a stack_t linked list.
+ * monty_pop - Disposes of the uppermost element in a stack_t.
  *
  * This function takes a step in the Monty bytecode file and eliminates the
  * highest value element in the given stack. It's like pruning the stack's
@@ -111,48 +72,36 @@ void monty_pint(stack_t **stack, unsigned int line_number)
  */
 void monty_pop(stack_t **stack, unsigned int line_number)
 {
-	stack_t *next = NULL;
-
-	if ((*stack)->next == NULL)
+	if ((*stack)->len == 0)
 	{
-		set_op_tok_error(pop_error(line_number));
+		set_op_error(pop_error(line_number));
 		return;
 	}
 
-	next = (*stack)->next->next;
-	free((*stack)->next);
-	if (next)
-		next->prev = *stack;
-	(*stack)->next = next;
+	(*stack)->head = ((*stack)->head + 1) & ((*stack)->cap - 1);
+	(*stack)->len--;
 }
 
 /**
- * monty_swap - Reorders the top two elements in a stack_t linked list.
+ * monty_swap - Reorders the top two elements in a stack_t.
  *
- * This function takes the first two elements of the stack, swaps their
- * positions, and updates the stack accordingly. It is designed to work
- * with a stack represented as a linked list and is typically used within
- * a Monty bytecode file.
+ * This function takes the first two elements of the stack and swaps their
+ * values in place. It is typically used within a Monty bytecode file.
  *
  * @stack: A pointer to the top node of a stack_t linked list.
  * @line_number: The current line number in the Monty bytecode file.
  */
 void monty_swap(stack_t **stack, unsigned int line_number)
 {
-	stack_t *tmp;
+	int tmp;
 
-	if ((*stack)->next == NULL || (*stack)->next->next == NULL)
+	if ((*stack)->len < 2)
 	{
-		set_op_tok_error(short_stack_error(line_number, "swap"));
+		set_op_error(short_stack_error(line_number, "swap"));
 		return;
 	}
 
-	tmp = (*stack)->next->next;
-	(*stack)->next->next = tmp->next;
-	(*stack)->next->prev = tmp;
-	if (tmp->next)
-		tmp->next->prev = (*stack)->next;
-	tmp->next = (*stack)->next;
-	tmp->prev = *stack;
-	(*stack)->next = tmp;
+	tmp = STACK_AT(*stack, 0);
+	STACK_AT(*stack, 0) = STACK_AT(*stack, 1);
+	STACK_AT(*stack, 1) = tmp;
 }
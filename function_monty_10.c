@@ -0,0 +1,93 @@
+#include "monty.h"
+
+void monty_roll(stack_t **stack, unsigned int line_number);
+void monty_drop(stack_t **stack, unsigned int line_number);
+int stack_reach(stack_t *stack, size_t depth, unsigned int line_number,
+		char *op);
+
+/**
+ * monty_roll - Moves the value N places below the top to the top.
+ * @stack: Pointer to the top node of a stack_t.
+ * @line_number: The current line in a Monty bytecode file.
+ *
+ * "roll 1" is swap; the N values above the moved one each go down one.
+ */
+void monty_roll(stack_t **stack, unsigned int line_number)
+{
+	stack_t *s = *stack;
+	size_t i;
+	int n;
+
+	if (stack_reach(s, vm.arg, line_number, "roll") != EXIT_SUCCESS)
+		return;
+	n = STACK_AT(s, vm.arg);
+	for (i = vm.arg; i > 0; i--)
+		STACK_AT(s, i) = STACK_AT(s, i - 1);
+	STACK_AT(s, 0) = n;
+}
+
+/**
+ * monty_drop - Removes the top N values.
+ * @stack: Pointer to the top node of a stack_t.
+ * @line_number: The current line in a Monty bytecode file.
+ *
+ * The ring buffer drops its values in one step; with --spill, spilled
+ * ones are brought back a chunk at a time to be dropped in turn.
+ */
+void monty_drop(stack_t **stack, unsigned int line_number)
+{
+	stack_t *s = *stack;
+	size_t n = vm.arg, k;
+	int status = EXIT_SUCCESS;
+
+	if (n > STACK_DEPTH(s))
+	{
+		set_op_error(short_stack_error(line_number, "drop"));
+		return;
+	}
+	while (n > 0 && status == EXIT_SUCCESS)
+	{
+		if (s->len == 0)
+			status = spill_reach(s, 0);
+		k = n < s->len ? n : s->len;
+		s->head = (s->head + k) & (s->cap - 1);
+		s->len -= k;
+		n -= k;
+	}
+	if (status != EXIT_SUCCESS)
+		set_op_error(limit_error(status, line_number, "drop"));
+}
+
+/**
+ * stack_reach - Checks that a stack_t holds a value at a given depth, and
+ * makes it addressable with STACK_AT.
+ * @stack: The stack_t.
+ * @depth: Places below the top; 0 is the top.
+ * @line_number: The current line in a Monty bytecode file.
+ * @op: The opcode, for error messages.
+ *
+ * With --spill, a value below the ring buffer is read back first.
+ *
+ * Return: EXIT_SUCCESS, or EXIT_FAILURE after setting the opcode error.
+ */
+int stack_reach(stack_t *stack, size_t depth, unsigned int line_number,
+		char *op)
+{
+	int status;
+
+	if (depth >= STACK_DEPTH(stack))
+	{
+		set_op_error(short_stack_error(line_number, op));
+		return (EXIT_FAILURE);
+	}
+	if (depth >= stack->len)
+	{
+		status = spill_reach(stack, depth);
+		if (status != EXIT_SUCCESS)
+		{
+			set_op_error(limit_error(status, line_number, op));
+			return (EXIT_FAILURE);
+		}
+	}
+	return (EXIT_SUCCESS);
+}
@@ -0,0 +1,66 @@
+#include "monty.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+void monty_load(stack_t **stack, unsigned int line_number);
+void monty_save(stack_t **stack, unsigned int line_number);
+
+/**
+ * monty_load - Pushes the values of a file of little-endian int32s.
+ * @stack: Pointer to the top node of a stack_t.
+ * @line_number: The current line in a Monty bytecode file.
+ *
+ * The file is mapped and its values pushed first to last, as push
+ * would, by stack_load.
+ */
+void monty_load(stack_t **stack, unsigned int line_number)
+{
+	char *path = vm.prog->names[vm.arg];
+	struct stat st;
+	void *map = NULL;
+	int fd, status = STACK_IO;
+
+	fd = open(path, O_RDONLY);
+	if (fd != -1 && fstat(fd, &st) == 0 && st.st_size % sizeof(int) == 0)
+	{
+		if (st.st_size > 0)
+			map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE,
+				   fd, 0);
+		if (map != MAP_FAILED)
+		{
+			status = stack_load(*stack, map,
+					    st.st_size / sizeof(int));
+			if (map != NULL)
+				munmap(map, st.st_size);
+		}
+	}
+	if (fd != -1)
+		close(fd);
+	if (status == STACK_LIMIT)
+		set_op_error(limit_error(status, line_number, "load"));
+	else if (status != EXIT_SUCCESS)
+		set_op_error(file_error(status, line_number, "load", path));
+}
+
+/**
+ * monty_save - Writes the values of the stack to a file of little-endian
+ * int32s, in the order load would push them back.
+ * @stack: Pointer to the top node of a stack_t.
+ * @line_number: The current line in a Monty bytecode file.
+ */
+void monty_save(stack_t **stack, unsigned int line_number)
+{
+	char *path = vm.prog->names[vm.arg];
+	int fd, status = STACK_IO;
+
+	fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+	if (fd != -1)
+	{
+		status = stack_save(*stack, fd);
+		if (close(fd) == -1 && status == EXIT_SUCCESS)
+			status = STACK_IO;
+	}
+	if (status != EXIT_SUCCESS)
+		set_op_error(file_error(status, line_number, "save", path));
+}
@@ -0,0 +1,89 @@
+#include "monty.h"
+
+void monty_store(stack_t **stack, unsigned int line_number);
+void monty_fetch(stack_t **stack, unsigned int line_number);
+void monty_has(stack_t **stack, unsigned int line_number);
+void monty_del(stack_t **stack, unsigned int line_number);
+
+/**
+ * monty_store - Pops a key, then its value, into the map.
+ * @stack: Pointer to the top node of a stack_t.
+ * @line_number: The current line in a Monty bytecode file.
+ *
+ * "push value, push key, store" maps key to value, replacing any value
+ * it had. All stacks of the bank share one map.
+ */
+void monty_store(stack_t **stack, unsigned int line_number)
+{
+	stack_t *s = *stack;
+	int status;
+
+	if (s->len < 2)
+	{
+		set_op_error(short_stack_error(line_number, "store"));
+		return;
+	}
+	status = map_put(STACK_MAP(s), STACK_AT(s, 0), STACK_AT(s, 1));
+	if (status != EXIT_SUCCESS)
+	{
+		set_op_error(limit_error(status, line_number, "store"));
+		return;
+	}
+	s->head = (s->head + 2) & (s->cap - 1);
+	s->len -= 2;
+}
+
+/**
+ * monty_fetch - Replaces the key on top with its value in the map.
+ * @stack: Pointer to the top node of a stack_t.
+ * @line_number: The current line in a Monty bytecode file.
+ */
+void monty_fetch(stack_t **stack, unsigned int line_number)
+{
+	int *val;
+
+	if ((*stack)->len == 0)
+	{
+		set_op_error(empty_stack_error(line_number, "fetch"));
+		return;
+	}
+	val = map_get(*STACK_MAP(*stack), STACK_AT(*stack, 0));
+	if (val == NULL)
+	{
+		set_op_error(key_error(line_number, "fetch"));
+		return;
+	}
+	STACK_AT(*stack, 0) = *val;
+}
+
+/**
+ * monty_has - Replaces the key on top with 1 if it is in the map, else 0.
+ * @stack: Pointer to the top node of a stack_t.
+ * @line_number: The current line in a Monty bytecode file.
+ */
+void monty_has(stack_t **stack, unsigned int line_number)
+{
+	if ((*stack)->len == 0)
+	{
+		set_op_error(empty_stack_error(line_number, "has"));
+		return;
+	}
+	STACK_AT(*stack, 0) =
+		map_get(*STACK_MAP(*stack), STACK_AT(*stack, 0)) != NULL;
+}
+
+/**
+ * monty_del - Pops a key and removes it from the map, if it is there.
+ * @stack: Pointer to the top node of a stack_t.
+ * @line_number: The current line in a Monty bytecode file.
+ */
+void monty_del(stack_t **stack, unsigned int line_number)
+{
+	if ((*stack)->len == 0)
+	{
+		set_op_error(empty_stack_error(line_number, "del"));
+		return;
+	}
+	map_del(*STACK_MAP(*stack), STACK_AT(*stack, 0));
+	monty_pop(stack, line_number);
+}
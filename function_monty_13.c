@@ -0,0 +1,70 @@
+#include "monty.h"
+
+void monty_read(stack_t **stack, unsigned int line_number);
+void monty_readall(stack_t **stack, unsigned int line_number);
+
+/**
+ * monty_read - Pushes the next integer read from stdin.
+ * @stack: Pointer to the top node of a stack_t.
+ * @line_number: The current line in a Monty bytecode file.
+ *
+ * A --green VM whose stdin has nothing yet yields (VM_WAIT) and runs the
+ * read again once it has.
+ */
+void monty_read(stack_t **stack, unsigned int line_number)
+{
+	int n, status = input_int(vm.in, &n);
+
+	if (status == INPUT_WAIT)
+	{
+		vm.ip--;
+		vm.status = VM_WAIT;
+	}
+	else if (status == 0)
+		set_op_error(call_error(line_number, "read", "end of input"));
+	else if (status == -1)
+		set_op_error(call_error(line_number, "read", "not an integer"));
+	else
+	{
+		status = stack_push(*stack, n);
+		if (status != EXIT_SUCCESS)
+			set_op_error(limit_error(status, line_number, "read"));
+	}
+}
+
+/**
+ * monty_readall - Pushes every integer left on stdin, the last one on top.
+ * @stack: Pointer to the top node of a stack_t.
+ * @line_number: The current line in a Monty bytecode file.
+ *
+ * Values are gathered READ_BATCH at a time, last first, so each batch
+ * goes onto the stack with one stack_push_n. Like read, it yields when
+ * stdin has nothing yet, keeping what it pushed, and goes on from there.
+ */
+void monty_readall(stack_t **stack, unsigned int line_number)
+{
+	int batch[READ_BATCH], got = 1, status = EXIT_SUCCESS;
+	size_t n = 0;
+
+	while (got == 1 && status == EXIT_SUCCESS)
+	{
+		got = input_int(vm.in, &batch[READ_BATCH - 1 - n]);
+		n += got == 1;
+		if (n == READ_BATCH || (got != 1 && n > 0))
+		{
+			status = stack_push_n(*stack, batch + READ_BATCH - n,
+					      n);
+			n = 0;
+		}
+	}
+	if (status != EXIT_SUCCESS)
+		set_op_error(limit_error(status, line_number, "readall"));
+	else if (got == INPUT_WAIT)
+	{
+		vm.ip--;
+		vm.status = VM_WAIT;
+	}
+	else if (got == -1)
+		set_op_error(call_error(line_number, "readall",
+					"not an integer"));
+}
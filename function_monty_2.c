@@ -17,13 +17,13 @@ void monty_mod(stack_t **stack, unsigned int line_number);
 
 void monty_add(stack_t **stack, unsigned int line_number)
 {
-	if ((*stack)->next == NULL || (*stack)->next->next == NULL)
+	if ((*stack)->len < 2)
 	{
-		set_op_tok_error(short_stack_error(line_number, "add"));
+		set_op_error(short_stack_error(line_number, "add"));
 		return;
 	}
 
-	(*stack)->next->next->n += (*stack)->next->n;
+	STACK_AT(*stack, 1) += STACK_AT(*stack, 0);
 	monty_pop(stack, line_number);
 }
 
@@ -40,13 +40,13 @@ void monty_add(stack_t **stack, unsigned int line_number)
  */
 void monty_sub(stack_t **stack, unsigned int line_number)
 {
-	if ((*stack)->next == NULL || (*stack)->next->next == NULL)
+	if ((*stack)->len < 2)
 	{
-		set_op_tok_error(short_stack_error(line_number, "sub"));
+		set_op_error(short_stack_error(line_number, "sub"));
 		return;
 	}
 
-	(*stack)->next->next->n -= (*stack)->next->n;
+	STACK_AT(*stack, 1) -= STACK_AT(*stack, 0);
 	monty_pop(stack, line_number);
 }
 
@@ -60,19 +60,19 @@ void monty_sub(stack_t **stack, unsigned int line_number)
  */
 void monty_div(stack_t **stack, unsigned int line_number)
 {
-	if ((*stack)->next == NULL || (*stack)->next->next == NULL)
+	if ((*stack)->len < 2)
 	{
-		set_op_tok_error(short_stack_error(line_number, "div"));
+		set_op_error(short_stack_error(line_number, "div"));
 		return;
 	}
 
-	if ((*stack)->next->n == 0)
+	if (STACK_AT(*stack, 0) == 0)
 	{
-		set_op_tok_error(div_error(line_number));
+		set_op_error(div_error(line_number));
 		return;
 	}
 
-	(*stack)->next->next->n /= (*stack)->next->n;
+	STACK_AT(*stack, 1) /= STACK_AT(*stack, 0);
 	monty_pop(stack, line_number);
 }
 
@@ -87,13 +87,13 @@ void monty_div(stack_t **stack, unsigned int line_number)
  */
 void monty_mul(stack_t **stack, unsigned int line_number)
 {
-	if ((*stack)->next == NULL || (*stack)->next->next == NULL)
+	if ((*stack)->len < 2)
 	{
-		set_op_tok_error(short_stack_error(line_number, "mul"));
+		set_op_error(short_stack_error(line_number, "mul"));
 		return;
 	}
 
-	(*stack)->next->next->n *= (*stack)->next->n;
+	STACK_AT(*stack, 1) *= STACK_AT(*stack, 0);
 	monty_pop(stack, line_number);
 }
 
@@ -108,18 +108,18 @@ void monty_mul(stack_t **stack, unsigned int line_number)
  */
 void monty_mod(stack_t **stack, unsigned int line_number)
 {
-	if ((*stack)->next == NULL || (*stack)->next->next == NULL)
+	if ((*stack)->len < 2)
 	{
-		set_op_tok_error(short_stack_error(line_number, "mod"));
+		set_op_error(short_stack_error(line_number, "mod"));
 		return;
 	}
 
-	if ((*stack)->next->n == 0)
+	if (STACK_AT(*stack, 0) == 0)
 	{
-		set_op_tok_error(div_error(line_number));
+		set_op_error(div_error(line_number));
 		return;
 	}
 
-	(*stack)->next->next->n %= (*stack)->next->n;
+	STACK_AT(*stack, 1) %= STACK_AT(*stack, 0);
 	monty_pop(stack, line_number);
 }
@@ -23,19 +23,19 @@ void monty_nop(stack_t **stack, unsigned int line_number)
  */
 void monty_pchar(stack_t **stack, unsigned int line_number)
 {
-	if ((*stack)->next == NULL)
+	if ((*stack)->len == 0)
 	{
-		set_op_tok_error(pchar_error(line_number, "stack empty"));
+		set_op_error(pchar_error(line_number, "stack empty"));
 		return;
 	}
-	if ((*stack)->next->n < 0 || (*stack)->next->n > 127)
+	if (STACK_AT(*stack, 0) < 0 || STACK_AT(*stack, 0) > 127)
 	{
-		set_op_tok_error(pchar_error(line_number,
+		set_op_error(pchar_error(line_number,
 					     "value out of range"));
 		return;
 	}
 
-	printf("%c\n", (*stack)->next->n);
+	printf("%c\n", STACK_AT(*stack, 0));
 }
 
 /**
@@ -45,15 +45,24 @@ void monty_pchar(stack_t **stack, unsigned int line_number)
  */
 void monty_pstr(stack_t **stack, unsigned int line_number)
 {
-	stack_t *tmp = (*stack)->next;
+	size_t i;
+	int c;
 
-	while (tmp && tmp->n != 0 && (tmp->n > 0 && tmp->n <= 127))
+	if ((*stack)->spill != NULL)
 	{
-		printf("%c", tmp->n);
-		tmp = tmp->next;
+		if (spill_print(*stack, 1) != EXIT_SUCCESS)
+			set_op_error(limit_error(STACK_IO, line_number,
+						 "pstr"));
+		printf("\n");
+		return;
+	}
+	for (i = 0; i < (*stack)->len; i++)
+	{
+		c = STACK_AT(*stack, i);
+		if (c <= 0 || c > 127)
+			break;
+		printf("%c", c);
 	}
 
 	printf("\n");
-
-	(void)line_number;
 }
@@ -4,6 +4,7 @@ void monty_rotl(stack_t **stack, unsigned int line_number);
 void monty_rotr(stack_t **stack, unsigned int line_number);
 void monty_stack(stack_t **stack, unsigned int line_number);
 void monty_queue(stack_t **stack, unsigned int line_number);
+void monty_rotn(stack_t **stack, unsigned int line_number);
 
 /**
  * monty_rotl - Swirls the front element of a stack to the back.
@@ -13,50 +14,23 @@ void monty_queue(stack_t **stack, unsigned int line_number);
 
 void monty_rotl(stack_t **stack, unsigned int line_number)
 {
-	stack_t *top, *bottom;
+	int status = stack_rotate(*stack, 1);
 
-	if ((*stack)->next == NULL || (*stack)->next->next == NULL)
-		return;
-
-	top = (*stack)->next;
-	bottom = (*stack)->next;
-	while (bottom->next != NULL)
-		bottom = bottom->next;
-
-	top->next->prev = *stack;
-	(*stack)->next = top->next;
-	bottom->next = top;
-	top->next = NULL;
-	top->prev = bottom;
-
-	(void)line_number;
+	if (status != EXIT_SUCCESS)
+		set_op_error(limit_error(status, line_number, "rotl"));
 }
 
 /**
- * monty_rotr - Elevates the lowermost item of a stack_t
- * linked list to the zenith.
- * @stack: A reference to the paramount node in a stack_t linked list.
+ * monty_rotr - Elevates the lowermost item of a stack_t to the zenith.
+ * @stack: A reference to the paramount node in a stack_t.
  * @line_number: The ongoing line number in a Monty bytecode manuscript.
  */
 void monty_rotr(stack_t **stack, unsigned int line_number)
 {
-	stack_t *top, *bottom;
+	int status = stack_rotate(*stack, -1);
 
-	if ((*stack)->next == NULL || (*stack)->next->next == NULL)
-		return;
-
-	top = (*stack)->next;
-	bottom = (*stack)->next;
-	while (bottom->next != NULL)
-		bottom = bottom->next;
-
-	bottom->prev->next = NULL;
-	(*stack)->next = bottom;
-	bottom->prev = *stack;
-	bottom->next = top;
-	top->prev = bottom;
-
-	(void)line_number;
+	if (status != EXIT_SUCCESS)
+		set_op_error(limit_error(status, line_number, "rotr"));
 }
 
 /**
@@ -67,7 +41,7 @@ void monty_rotr(stack_t **stack, unsigned int line_number)
  */
 void monty_stack(stack_t **stack, unsigned int line_number)
 {
-	(*stack)->n = STACK;
+	(*stack)->mode = STACK;
 	(void)line_number;
 }
 
@@ -78,10 +52,25 @@ void monty_stack(stack_t **stack, unsigned int line_number)
  * @line_number: The current line in a Monty bytecode file.
  *
  * This function takes the stack and makes it behave like a queue.
- * It shifts the order of elements to process them in a FIFO manner.
+ * Only the mode flag changes; later pushes go to the bottom (FIFO).
  */
 void monty_queue(stack_t **stack, unsigned int line_number)
 {
-	(*stack)->n = QUEUE;
+	(*stack)->mode = QUEUE;
 	(void)line_number;
 }
+
+/**
+ * monty_rotn - Rotates a stack_t by N positions in one step.
+ * @stack: Pointer to the top element of a stack_t.
+ * @line_number: The current line in a Monty bytecode file.
+ *
+ * "rotn N" has the effect of N rotl (or -N rotr when N is negative).
+ */
+void monty_rotn(stack_t **stack, unsigned int line_number)
+{
+	int status = stack_rotate(*stack, vm.arg);
+
+	if (status != EXIT_SUCCESS)
+		set_op_error(limit_error(status, line_number, "rotn"));
+}
@@ -0,0 +1,81 @@
+#include "monty.h"
+
+void monty_jmp(stack_t **stack, unsigned int line_number);
+void monty_jz(stack_t **stack, unsigned int line_number);
+void monty_jnz(stack_t **stack, unsigned int line_number);
+void monty_loop(stack_t **stack, unsigned int line_number);
+
+/**
+ * monty_jmp - Continues execution at a label.
+ * @stack: Pointer to the top node of a stack_t (unused).
+ * @line_number: The current line in a Monty bytecode file.
+ *
+ * The label was resolved to an instruction index when the script loaded.
+ */
+void monty_jmp(stack_t **stack, unsigned int line_number)
+{
+	vm.ip = vm.arg;
+	(void)stack;
+	(void)line_number;
+}
+
+/**
+ * monty_jz - Jumps to a label when the top value is zero.
+ * @stack: Pointer to the top node of a stack_t.
+ * @line_number: The current line in a Monty bytecode file.
+ *
+ * The tested value stays on the stack.
+ */
+void monty_jz(stack_t **stack, unsigned int line_number)
+{
+	if ((*stack)->len == 0)
+	{
+		set_op_error(empty_stack_error(line_number, "jz"));
+		return;
+	}
+
+	if (STACK_AT(*stack, 0) == 0)
+		vm.ip = vm.arg;
+}
+
+/**
+ * monty_jnz - Jumps to a label when the top value is not zero.
+ * @stack: Pointer to the top node of a stack_t.
+ * @line_number: The current line in a Monty bytecode file.
+ *
+ * The tested value stays on the stack.
+ */
+void monty_jnz(stack_t **stack, unsigned int line_number)
+{
+	if ((*stack)->len == 0)
+	{
+		set_op_error(empty_stack_error(line_number, "jnz"));
+		return;
+	}
+
+	if (STACK_AT(*stack, 0) != 0)
+		vm.ip = vm.arg;
+}
+
+/**
+ * monty_loop - Closes a counted loop whose counter is the top value.
+ * @stack: Pointer to the top node of a stack_t.
+ * @line_number: The current line in a Monty bytecode file.
+ *
+ * Description: Decrements the counter and jumps back to the label while it
+ * is still positive; otherwise the counter is popped and execution falls
+ * through. "push 3 / label l / ... / loop l" runs the body three times.
+ */
+void monty_loop(stack_t **stack, unsigned int line_number)
+{
+	if ((*stack)->len == 0)
+	{
+		set_op_error(empty_stack_error(line_number, "loop"));
+		return;
+	}
+
+	if (--STACK_AT(*stack, 0) > 0)
+		vm.ip = vm.arg;
+	else
+		monty_pop(stack, line_number);
+}
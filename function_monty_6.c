@@ -0,0 +1,78 @@
+#include "monty.h"
+
+void bf_add(stack_t **stack, unsigned int line_number);
+void bf_out(stack_t **stack, unsigned int line_number);
+void bf_in(stack_t **stack, unsigned int line_number);
+void bf_clear(stack_t **stack, unsigned int line_number);
+void bf_mul(stack_t **stack, unsigned int line_number);
+
+/*
+ * Brainfuck opcodes. The tape is a full BF_TAPE-cell stack_t whose top is
+ * the current cell, so pointer moves are rotn and loops are jz/jnz; cells
+ * hold 0..255 and wrap like bytes.
+ */
+
+/**
+ * bf_add - Adds the operand to the current cell (a run of + or -).
+ * @stack: The Brainfuck tape.
+ * @line_number: Line of the run in the Brainfuck source.
+ */
+void bf_add(stack_t **stack, unsigned int line_number)
+{
+	STACK_AT(*stack, 0) = (STACK_AT(*stack, 0) + vm.arg) & 0xff;
+	(void)line_number;
+}
+
+/**
+ * bf_out - Writes the current cell as a byte (the . command).
+ * @stack: The Brainfuck tape.
+ * @line_number: Line of the command in the Brainfuck source.
+ */
+void bf_out(stack_t **stack, unsigned int line_number)
+{
+	putchar(STACK_AT(*stack, 0));
+	(void)line_number;
+}
+
+/**
+ * bf_in - Reads a byte from stdin into the current cell (the , command).
+ * @stack: The Brainfuck tape.
+ * @line_number: Line of the command in the Brainfuck source.
+ *
+ * The cell is set to 0 at end of input.
+ */
+void bf_in(stack_t **stack, unsigned int line_number)
+{
+	int c = getchar();
+
+	STACK_AT(*stack, 0) = (c == EOF) ? 0 : c;
+	(void)line_number;
+}
+
+/**
+ * bf_clear - Zeroes the current cell (the [-] and [+] idioms).
+ * @stack: The Brainfuck tape.
+ * @line_number: Line of the loop in the Brainfuck source.
+ */
+void bf_clear(stack_t **stack, unsigned int line_number)
+{
+	STACK_AT(*stack, 0) = 0;
+	(void)line_number;
+}
+
+/**
+ * bf_mul - Adds a multiple of the current cell to another cell.
+ * @stack: The Brainfuck tape.
+ * @line_number: Line of the loop in the Brainfuck source.
+ *
+ * Description: One step of a multiply loop such as [->+++<]. The operand
+ * packs the cell offset and the factor as offset * 256 + factor.
+ */
+void bf_mul(stack_t **stack, unsigned int line_number)
+{
+	int factor = vm.arg & 0xff, offset = (vm.arg - factor) / 256;
+
+	STACK_AT(*stack, offset) = (STACK_AT(*stack, offset) +
+				    STACK_AT(*stack, 0) * factor) & 0xff;
+	(void)line_number;
+}
@@ -0,0 +1,72 @@
+#include "monty.h"
+
+void monty_select(stack_t **stack, unsigned int line_number);
+void monty_movto(stack_t **stack, unsigned int line_number);
+void monty_movfrom(stack_t **stack, unsigned int line_number);
+
+/**
+ * monty_select - Makes another stack of the bank the current one.
+ * @stack: Pointer to the current stack_t.
+ * @line_number: The current line in a Monty bytecode file.
+ *
+ * Every other opcode works on the current stack; each stack keeps its
+ * own values and STACK/QUEUE mode.
+ */
+void monty_select(stack_t **stack, unsigned int line_number)
+{
+	*stack += vm.arg - (*stack)->id;
+	(void)line_number;
+}
+
+/**
+ * monty_movto - Moves the top value of the current stack onto another.
+ * @stack: Pointer to the current stack_t.
+ * @line_number: The current line in a Monty bytecode file.
+ *
+ * The value is pushed according to the mode of the receiving stack.
+ */
+void monty_movto(stack_t **stack, unsigned int line_number)
+{
+	stack_t *from = *stack, *to = *stack + (vm.arg - (*stack)->id);
+	int n;
+
+	if (from->len == 0)
+	{
+		set_op_error(empty_stack_error(line_number, "movto"));
+		return;
+	}
+
+	n = from->vals[from->head];
+	from->head = (from->head + 1) & (from->cap - 1);
+	from->len--;
+	n = stack_push(to, n);
+	if (n != EXIT_SUCCESS)
+		set_op_error(limit_error(n, line_number, "movto"));
+}
+
+/**
+ * monty_movfrom - Moves the top value of another stack onto the current
+ * one.
+ * @stack: Pointer to the current stack_t.
+ * @line_number: The current line in a Monty bytecode file.
+ *
+ * The value is pushed according to the mode of the current stack.
+ */
+void monty_movfrom(stack_t **stack, unsigned int line_number)
+{
+	stack_t *from = *stack + (vm.arg - (*stack)->id), *to = *stack;
+	int n;
+
+	if (from->len == 0)
+	{
+		set_op_error(empty_stack_error(line_number, "movfrom"));
+		return;
+	}
+
+	n = from->vals[from->head];
+	from->head = (from->head + 1) & (from->cap - 1);
+	from->len--;
+	n = stack_push(to, n);
+	if (n != EXIT_SUCCESS)
+		set_op_error(limit_error(n, line_number, "movfrom"));
+}
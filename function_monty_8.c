@@ -0,0 +1,76 @@
+#include "monty.h"
+
+void monty_def(stack_t **stack, unsigned int line_number);
+void monty_end(stack_t **stack, unsigned int line_number);
+void monty_call(stack_t **stack, unsigned int line_number);
+void monty_ret(stack_t **stack, unsigned int line_number);
+
+/**
+ * monty_def - Skips over a subroutine body.
+ * @stack: Pointer to the top node of a stack_t (unused).
+ * @line_number: The current line in a Monty bytecode file.
+ *
+ * The body only runs through call; its end was matched when the script
+ * loaded and the operand is the instruction after it.
+ */
+void monty_def(stack_t **stack, unsigned int line_number)
+{
+	vm.ip = vm.arg;
+	(void)stack;
+	(void)line_number;
+}
+
+/**
+ * monty_end - Returns from a subroutine at the end of its body.
+ * @stack: Pointer to the top node of a stack_t (unused).
+ * @line_number: The current line in a Monty bytecode file.
+ */
+void monty_end(stack_t **stack, unsigned int line_number)
+{
+	if (vm.rsp == 0)
+	{
+		set_op_error(call_error(line_number, "end",
+					"return stack empty"));
+		return;
+	}
+	vm.ip = vm.ret[--vm.rsp];
+	(void)stack;
+}
+
+/**
+ * monty_call - Runs a subroutine, or the code after any label.
+ * @stack: Pointer to the top node of a stack_t (unused).
+ * @line_number: The current line in a Monty bytecode file.
+ *
+ * The name was resolved to an instruction index when the script loaded;
+ * the return address goes on vm.ret, apart from the data stacks.
+ */
+void monty_call(stack_t **stack, unsigned int line_number)
+{
+	if (vm.rsp == RET_DEPTH)
+	{
+		set_op_error(call_error(line_number, "call",
+					"return stack full"));
+		return;
+	}
+	vm.ret[vm.rsp++] = vm.ip;
+	vm.ip = vm.arg;
+	(void)stack;
+}
+
+/**
+ * monty_ret - Returns from a subroutine.
+ * @stack: Pointer to the top node of a stack_t (unused).
+ * @line_number: The current line in a Monty bytecode file.
+ */
+void monty_ret(stack_t **stack, unsigned int line_number)
+{
+	if (vm.rsp == 0)
+	{
+		set_op_error(call_error(line_number, "ret",
+					"return stack empty"));
+		return;
+	}
+	vm.ip = vm.ret[--vm.rsp];
+	(void)stack;
+}
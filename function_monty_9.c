@@ -0,0 +1,86 @@
+#include "monty.h"
+
+void monty_push_pool(stack_t **stack, unsigned int line_number);
+void monty_dup(stack_t **stack, unsigned int line_number);
+void monty_over(stack_t **stack, unsigned int line_number);
+void monty_pick(stack_t **stack, unsigned int line_number);
+
+/**
+ * monty_push_pool - Pushes a pooled literal: for pushs the characters of
+ * a string, first one on top, for pushn a list of integers, last one on
+ * top.
+ * @stack: Pointer to the top node of a stack_t.
+ * @line_number: The current line in a Monty bytecode file.
+ *
+ * The literal was pooled in stack order when the script loaded and is
+ * copied in bulk. Errors name the opcode of the running instruction.
+ */
+void monty_push_pool(stack_t **stack, unsigned int line_number)
+{
+	int *lit = vm.prog->pool + vm.arg;
+	int status = stack_push_n(*stack, lit + 1, lit[0]);
+
+	if (status != EXIT_SUCCESS)
+		set_op_error(limit_error(status, line_number,
+			op_table[vm.prog->code[vm.ip - 1].op].opcode));
+}
+
+/**
+ * monty_dup - Pushes a copy of the top value.
+ * @stack: Pointer to the top node of a stack_t.
+ * @line_number: The current line in a Monty bytecode file.
+ */
+void monty_dup(stack_t **stack, unsigned int line_number)
+{
+	int status;
+
+	if (stack_reach(*stack, 0, line_number, "dup") != EXIT_SUCCESS)
+		return;
+	status = stack_push(*stack, STACK_AT(*stack, 0));
+	if (status != EXIT_SUCCESS)
+		set_op_error(limit_error(status, line_number, "dup"));
+}
+
+/**
+ * monty_over - Pushes a copy of the value below the top.
+ * @stack: Pointer to the top node of a stack_t.
+ * @line_number: The current line in a Monty bytecode file.
+ */
+void monty_over(stack_t **stack, unsigned int line_number)
+{
+	int status;
+
+	if (stack_reach(*stack, 1, line_number, "over") != EXIT_SUCCESS)
+		return;
+	status = stack_push(*stack, STACK_AT(*stack, 1));
+	if (status != EXIT_SUCCESS)
+		set_op_error(limit_error(status, line_number, "over"));
+}
+
+/**
+ * monty_pick - Pushes a copy of the value N places below the top.
+ * @stack: Pointer to the top node of a stack_t.
+ * @line_number: The current line in a Monty bytecode file.
+ *
+ * "pick 0" is dup and "pick 1" is over. Like push, the copy goes to the
+ * bottom in queue mode. With --spill, a value below the ring buffer is
+ * read straight from the spill file.
+ */
+void monty_pick(stack_t **stack, unsigned int line_number)
+{
+	int status = EXIT_SUCCESS, n;
+
+	if ((size_t)vm.arg >= STACK_DEPTH(*stack))
+	{
+		set_op_error(short_stack_error(line_number, "pick"));
+		return;
+	}
+	if ((size_t)vm.arg < (*stack)->len)
+		n = STACK_AT(*stack, vm.arg);
+	else
+		status = spill_peek(*stack, vm.arg, &n);
+	if (status == EXIT_SUCCESS)
+		status = stack_push(*stack, n);
+	if (status != EXIT_SUCCESS)
+		set_op_error(limit_error(status, line_number, "pick"));
+}
@@ -0,0 +1,134 @@
+/*
+ * diff_gen.c - Random script generator of the Monty differential tester.
+ *
+ * See diff_monty.c. The same seed always yields the same script, so a
+ * mismatch can be written out again by resetting rng.
+ */
+#include <stdio.h>
+#include <string.h>
+
+#define DIFF_LEGACY_OPS 17
+
+static const char * const ops[] = {
+	"push", "pall", "pint", "pop", "swap", "add", "nop", "sub", "div",
+	"mul", "mod", "pchar", "pstr", "rotl", "rotr", "stack", "queue",
+	"rotn", "jmp", "jz", "jnz", "loop", "select", "movto", "movfrom",
+	"def", "end", "call", "ret", "pushs", "pushn", "dup", "over", "pick",
+	"roll", "drop", "read", "readall", "store", "fetch", "has", "del"
+};
+
+/* Operands for pushs */
+static const char * const strs[] = {
+	"\"\"", "\"Hi\"", "\"a\\tb\\n\"", "\"say \\\"hi\\\"\"", "\"\\x41\\0B\"",
+	"\"unterminated"
+};
+
+/* Lines that exercise tokenizing and comment handling */
+static const char * const odd[] = {
+	"", "   ", "\t", "#", "# comment", "   # indented comment", "#push 1",
+	"push 1 # trailing", "push 1 2", "push", "push -", "push +1",
+	"push 1x", "push --1", "push 2147483647", "push -2147483648",
+	"push 99999999999", "PUSH 1", "bogus", "pall extra", "nop#",
+	"  push\t7  ", "push\t-0"
+};
+
+unsigned long rng;
+
+unsigned long diff_rand(unsigned long n);
+void diff_gen(FILE *f, int legacy);
+void diff_gen_op(FILE *f, const char *op, unsigned long *defs);
+
+/**
+ * diff_rand - Returns a pseudo-random number (xorshift64).
+ * @n: Upper bound, exclusive; must not be 0.
+ *
+ * Return: A number in [0, n).
+ */
+unsigned long diff_rand(unsigned long n)
+{
+	rng ^= rng << 13;
+	rng ^= rng >> 7;
+	rng ^= rng << 17;
+	return (rng % n);
+}
+
+/**
+ * diff_gen - Writes a random script.
+ * @f: Where to write it.
+ * @legacy: Only use the original opcodes.
+ */
+void diff_gen(FILE *f, int legacy)
+{
+	unsigned long i, n = diff_rand(60), nops, defs = 0;
+	const char *op;
+
+	nops = legacy ? DIFF_LEGACY_OPS : sizeof(ops) / sizeof(*ops);
+	for (i = 0; i < n; i++)
+	{
+		if (diff_rand(10) == 0)
+		{
+			fprintf(f, "%s\n",
+				odd[diff_rand(sizeof(odd) / sizeof(*odd))]);
+			continue;
+		}
+		if (!legacy && diff_rand(12) == 0)
+		{
+			fprintf(f, "label %c\n", (int)('a' + diff_rand(3)));
+			continue;
+		}
+		op = diff_rand(3) == 0 ? "push" : ops[diff_rand(nops)];
+		diff_gen_op(f, op, &defs);
+	}
+	for (; defs > 0; defs--)
+		fprintf(f, "end\n");
+}
+
+/**
+ * diff_gen_op - Writes one instruction of a random script.
+ * @f: Where to write it.
+ * @op: The opcode.
+ * @defs: Number of defs left open; end is only written to close one, so
+ * most scripts load.
+ *
+ * def names (d and e) are called like labels (a to c), so a call may name
+ * either, or a name that does not exist.
+ */
+void diff_gen_op(FILE *f, const char *op, unsigned long *defs)
+{
+	unsigned long k;
+
+	if (strcmp(op, "push") == 0)
+		fprintf(f, "push %ld\n", (long)diff_rand(300) - 100);
+	else if (strcmp(op, "rotn") == 0)
+		fprintf(f, "rotn %ld\n", (long)diff_rand(11) - 5);
+	else if (op[0] == 'j' || strcmp(op, "loop") == 0)
+		fprintf(f, "%s %c\n", op, (int)('a' + diff_rand(3)));
+	else if (strcmp(op, "select") == 0 || strncmp(op, "mov", 3) == 0)
+		fprintf(f, "%s %lu\n", op, diff_rand(4));
+	else if (strcmp(op, "def") == 0 || strcmp(op, "call") == 0)
+	{
+		k = op[0] == 'd' ? 'd' + diff_rand(2) : 'a' + diff_rand(6);
+		fprintf(f, "%s %c\n", op, (int)k);
+		*defs += op[0] == 'd';
+	}
+	else if (strcmp(op, "end") == 0 && *defs == 0)
+		fprintf(f, "ret\n");
+	else if (strcmp(op, "pushs") == 0)
+		fprintf(f, "pushs %s\n",
+			strs[diff_rand(sizeof(strs) / sizeof(*strs))]);
+	else if (strcmp(op, "pushn") == 0)
+	{
+		fprintf(f, "pushn");
+		for (k = diff_rand(5); k > 0; k--)
+			fprintf(f, " %ld", (long)diff_rand(300) - 100);
+		fprintf(f, "\n");
+	}
+	else if (strcmp(op, "pick") == 0 || strcmp(op, "roll") == 0 ||
+		 strcmp(op, "drop") == 0)
+		fprintf(f, "%s %lu\n", op, diff_rand(5));
+	else
+	{
+		*defs -= strcmp(op, "end") == 0;
+		fprintf(f, "%s\n", op);
+	}
+}
@@ -0,0 +1,176 @@
+/*
+ * diff_monty.c - Differential tester for Monty engines.
+ *
+ * Generates random scripts and runs each through two command lines,
+ * comparing stdout, stderr and exit status byte for byte. Scripts that
+ * make the engines disagree are generated again into mismatch_N.m.
+ *
+ *	gcc -O2 -o diff_monty fuzz/diff_monty.c fuzz/diff_gen.c
+ *	./diff_monty [-n count] [-s seed] [-l] [-o dir] "CMD_A" "CMD_B"
+ *
+ * Each command is run with sh -c, with the script path appended, e.g.
+ *	./diff_monty -l ./monty_legacy "./monty --jit"
+ * -l restricts scripts to the original opcodes (no labels, jumps, rotn,
+ * stack bank, subroutines, stack words or map), for comparing against a
+ * legacy build. Both commands read the same small input on stdin; save
+ * and load are never generated, as the two runs would share the files.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <sys/wait.h>
+
+#define DIFF_TIMEOUT 5
+#define DIFF_INPUT "12 -7 300\n2147483647 x 5\n"
+
+extern unsigned long rng;
+
+void diff_gen(FILE *f, int legacy);
+int diff_run(const char *cmd, const char *script, const char *in,
+	     const char *out, const char *err);
+int diff_same(const char *a, const char *b);
+int main(int argc, char **argv);
+
+/**
+ * diff_run - Runs a command on a script, capturing its output.
+ * @cmd: The command line; the script path is appended.
+ * @script: Path of the script.
+ * @in: File to read stdin from.
+ * @out: File to store stdout in.
+ * @err: File to store stderr in.
+ *
+ * Return: The exit status, 128 + the signal if it was killed, or -1 if
+ * it timed out or could not be run.
+ */
+int diff_run(const char *cmd, const char *script, const char *in,
+	     const char *out, const char *err)
+{
+	char line[4096];
+	pid_t pid;
+	int status;
+
+	snprintf(line, sizeof(line), "exec %s %s", cmd, script);
+	pid = fork();
+	if (pid == 0)
+	{
+		dup2(open(out, O_WRONLY | O_CREAT | O_TRUNC, 0600),
+		     STDOUT_FILENO);
+		dup2(open(err, O_WRONLY | O_CREAT | O_TRUNC, 0600),
+		     STDERR_FILENO);
+		dup2(open(in, O_RDONLY), STDIN_FILENO);
+		alarm(DIFF_TIMEOUT);
+		execl("/bin/sh", "sh", "-c", line, (char *)NULL);
+		_exit(127);
+	}
+	if (pid == -1 || waitpid(pid, &status, 0) == -1)
+		return (-1);
+	if (WIFSIGNALED(status))
+		return (WTERMSIG(status) == SIGALRM ? -1 :
+			128 + WTERMSIG(status));
+	return (WEXITSTATUS(status));
+}
+
+/**
+ * diff_same - Compares two files byte for byte.
+ * @a: The first file.
+ * @b: The second file.
+ *
+ * Return: 1 if they are identical, 0 otherwise.
+ */
+int diff_same(const char *a, const char *b)
+{
+	FILE *fa = fopen(a, "r"), *fb = fopen(b, "r");
+	int ca = 0, cb = 0;
+
+	while (fa != NULL && fb != NULL && ca == cb && ca != EOF)
+	{
+		ca = getc(fa);
+		cb = getc(fb);
+	}
+	if (fa != NULL)
+		fclose(fa);
+	if (fb != NULL)
+		fclose(fb);
+	return (fa != NULL && fb != NULL && ca == cb);
+}
+
+/**
+ * main - Runs the differential test.
+ * @argc: Number of command-line arguments.
+ * @argv: Array of command-line argument strings.
+ *
+ * Return: 0 if every script behaved the same, 1 otherwise.
+ */
+int main(int argc, char **argv)
+{
+	char tmp[] = "/tmp/diff_monty.XXXXXX", p[7][4200], *dir = ".";
+	long i, n = 1000, bad = 0, skipped = 0;
+	unsigned long seed;
+	int c, legacy = 0, sa, sb;
+	FILE *f;
+
+	rng = 88172645463325252UL;
+	while ((c = getopt(argc, argv, "n:s:lo:")) != -1)
+	{
+		if (c == 'n')
+			n = atol(optarg);
+		else if (c == 's')
+			rng ^= strtoul(optarg, NULL, 10) * 2654435761UL;
+		else if (c == 'l')
+			legacy = 1;
+		else if (c == 'o')
+			dir = optarg;
+		else
+			return (1);
+	}
+	if (argc - optind != 2 || mkdtemp(tmp) == NULL)
+	{
+		fprintf(stderr, "USAGE: diff_monty [-n count] [-s seed] [-l] "
+			"[-o dir] CMD_A CMD_B\n");
+		return (1);
+	}
+	sprintf(p[0], "%s/t.m", tmp);
+	for (c = 1; c < 5; c++)
+		sprintf(p[c], "%s/%d", tmp, c);
+	sprintf(p[6], "%s/in", tmp);
+	f = fopen(p[6], "w");
+	if (f == NULL)
+		return (1);
+	fputs(DIFF_INPUT, f);
+	fclose(f);
+	for (i = 0; i < n; i++)
+	{
+		f = fopen(p[0], "w");
+		if (f == NULL)
+			return (1);
+		seed = rng;
+		diff_gen(f, legacy);
+		fclose(f);
+		sa = diff_run(argv[optind], p[0], p[6], p[1], p[2]);
+		sb = diff_run(argv[optind + 1], p[0], p[6], p[3], p[4]);
+		if (sa == -1 || sb == -1)
+			skipped++;
+		else if (sa != sb || !diff_same(p[1], p[3]) ||
+			 !diff_same(p[2], p[4]))
+		{
+			snprintf(p[5], sizeof(p[5]), "%s/mismatch_%ld.m", dir,
+				 ++bad);
+			f = fopen(p[5], "w");
+			if (f == NULL)
+				return (1);
+			rng = seed;
+			diff_gen(f, legacy);
+			fclose(f);
+			printf("%s: status %d vs %d\n", p[5], sa, sb);
+		}
+	}
+	for (c = 0; c < 5; c++)
+		unlink(p[c]);
+	unlink(p[6]);
+	rmdir(tmp);
+	printf("%ld scripts, %ld mismatches, %ld timed out\n", n, bad, skipped);
+	return (bad != 0);
+}
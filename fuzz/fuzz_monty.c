@@ -0,0 +1,206 @@
+/*
+ * fuzz_monty.c - libFuzzer/AFL entry point for the Monty interpreter.
+ *
+ * Each input is decoded as a Monty script and run by the interpreter with
+ * a step budget. When it finishes within the budget it is run again by
+ * the JIT, and the two runs must print the same stdout and stderr and
+ * exit with the same status; any difference aborts, so the fuzzer keeps
+ * the input as a crash. Both runs read from an empty stdin of their own,
+ * never the fuzzer's. Programs with save or load are skipped, as they
+ * would write and read files in the fuzzer's directory.
+ *
+ * libFuzzer:
+ *	clang -g -O1 -fsanitize=fuzzer,address -I. fuzz/fuzz_monty.c \
+ *		$(ls *.c | grep -v '^main.c$') -o fuzz_monty -lpthread
+ *	./fuzz_monty -close_fd_mask=1 tests/
+ * AFL (or a plain build, to replay one input from a file or stdin):
+ *	afl-cc -DMONTY_FUZZ_MAIN -I. fuzz/fuzz_monty.c \
+ *		$(ls *.c | grep -v '^main.c$') -o fuzz_monty -lpthread
+ */
+#include "monty.h"
+#include <stdint.h>
+#include <string.h>
+
+#define FUZZ_BUDGET (1L << 20)
+
+/**
+ * struct fuzz_res_s - What one run of a program printed and returned
+ * @out: Everything written to stdout
+ * @out_len: Length of @out
+ * @err: Everything written to stderr
+ * @err_len: Length of @err
+ * @status: The exit status, or -1 if the run did not finish
+ */
+typedef struct fuzz_res_s
+{
+	char *out;
+	size_t out_len;
+	char *err;
+	size_t err_len;
+	int status;
+} fuzz_res_t;
+
+__thread char **op_toks = NULL;
+opts_t opts;
+static input_t fuzz_in;
+
+int fuzz_exec(prog_t *prog, stack_t **stack);
+int fuzz_files(prog_t *prog);
+void fuzz_run(prog_t *prog, int jit, fuzz_res_t *res);
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+/**
+ * fuzz_exec - Runs a decoded program in the interpreter, within a budget.
+ * @prog: The decoded program.
+ * @stack: The stack_t the program operates on.
+ *
+ * Every instruction costs 1, and pall/pstr also cost the stack length, so
+ * neither endless loops nor endless output get past the budget.
+ *
+ * Return: The exit status, or -1 if the budget ran out first.
+ */
+int fuzz_exec(prog_t *prog, stack_t **stack)
+{
+	long budget = FUZZ_BUDGET;
+	instr_t *in;
+
+	vm.prog = prog;
+	vm.ip = 0;
+	vm.rsp = 0;
+	vm.status = EXIT_SUCCESS;
+	while (vm.ip < prog->len && vm.status == EXIT_SUCCESS)
+	{
+		in = &prog->code[vm.ip++];
+		budget -= 1;
+		if (in->op == OP_PALL || in->op == OP_PSTR)
+			budget -= (*stack)->len;
+		if (budget < 0)
+			return (-1);
+		vm.arg = in->arg;
+		op_table[in->op].f(stack, in->line);
+	}
+	return (vm.status);
+}
+
+/**
+ * fuzz_files - Checks whether a program touches files.
+ * @prog: The decoded program.
+ *
+ * Return: 1 if it contains save or load, else 0.
+ */
+int fuzz_files(prog_t *prog)
+{
+	size_t i;
+
+	for (i = 0; i < prog->len; i++)
+		if (prog->code[i].op == OP_SAVE || prog->code[i].op == OP_LOAD)
+			return (1);
+	return (0);
+}
+
+/**
+ * fuzz_run - Runs a decoded program, capturing its output.
+ * @prog: The decoded program.
+ * @jit: Run it with the JIT rather than the interpreter.
+ * @res: Where to store the output and status; status is -1 if the run
+ * did not finish (or the JIT could not compile the program).
+ *
+ * read and readall see an input that is already at its end.
+ */
+void fuzz_run(prog_t *prog, int jit, fuzz_res_t *res)
+{
+	FILE *saved_out = stdout, *saved_err = stderr;
+	input_t *saved_in = vm.in;
+	stack_t *stack = NULL;
+
+	memset(res, 0, sizeof(*res));
+	res->status = -1;
+	stdout = open_memstream(&res->out, &res->out_len);
+	stderr = open_memstream(&res->err, &res->err_len);
+	if (stdout == NULL || stderr == NULL || init_stack(&stack) != 0)
+		abort();
+	input_reset(&fuzz_in, -1, 0);
+	fuzz_in.eof = 1;
+	vm.in = &fuzz_in;
+	res->status = jit ? jit_exec(prog, &stack) : fuzz_exec(prog, &stack);
+	if (res->status == EXIT_SUCCESS && prog->nul_tail)
+		res->status = malloc_error();
+	free_stack(&stack);
+	fclose(stdout);
+	fclose(stderr);
+	stdout = saved_out;
+	stderr = saved_err;
+	vm.in = saved_in;
+}
+
+/**
+ * LLVMFuzzerTestOneInput - Decodes and runs one input.
+ * @data: The input, used as the text of a script.
+ * @size: Length of the input.
+ *
+ * Return: Always 0.
+ */
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+	fuzz_res_t a, b;
+	prog_t prog;
+	char *src;
+	FILE *saved_err = stderr;
+
+	src = malloc(size + 1);
+	if (src == NULL)
+		return (0);
+	memcpy(src, data, size);
+	memset(&prog, 0, sizeof(prog));
+	stderr = fopen("/dev/null", "w");
+	if (stderr != NULL && load_program_mem(src, size, &prog) == 0 &&
+	    !fuzz_files(&prog))
+	{
+		fuzz_run(&prog, 0, &a);
+		b.status = -1;
+		if (a.status != -1)
+			fuzz_run(&prog, 1, &b);
+		if (b.status != -1 && (a.status != b.status ||
+		    a.out_len != b.out_len || memcmp(a.out, b.out, a.out_len) ||
+		    a.err_len != b.err_len || memcmp(a.err, b.err, a.err_len)))
+			abort();
+		free(a.out);
+		free(a.err);
+		if (b.status != -1)
+		{
+			free(b.out);
+			free(b.err);
+		}
+	}
+	free_program(&prog);
+	if (stderr != NULL)
+		fclose(stderr);
+	stderr = saved_err;
+	free(src);
+	return (0);
+}
+
+#ifdef MONTY_FUZZ_MAIN
+/**
+ * main - Runs one input, from the file given as argument or from stdin.
+ * @argc: Number of command-line arguments.
+ * @argv: Array of command-line argument strings.
+ *
+ * Return: 0, or 1 if the input cannot be read.
+ */
+int main(int argc, char **argv)
+{
+	FILE *in = argc > 1 ? fopen(argv[1], "r") : stdin;
+	size_t len;
+	char *data;
+
+	if (in == NULL)
+		return (1);
+	data = read_stream(in, &len);
+	if (data == NULL)
+		return (1);
+	LLVMFuzzerTestOneInput((const uint8_t *)data, len);
+	free(data);
+	return (0);
+}
+#endif
@@ -0,0 +1,229 @@
+/* fopencookie is a GNU extension */
+#define _GNU_SOURCE
+#include "monty.h"
+#include <string.h>
+#include <sys/socket.h>
+
+void green_loop(serve_t *s, int listen_fd);
+void green_accept(sched_t *g, int listen_fd);
+green_t *green_new(sched_t *g);
+void green_start(sched_t *g, int c);
+void green_finish(sched_t *g, green_t *t);
+
+/**
+ * green_loop - Runs the jobs of a --green daemon worker until the process
+ * is killed.
+ * @s: The worker state.
+ * @listen_fd: The listening socket, non-blocking.
+ *
+ * Description: Instead of running one job to completion at a time, the
+ * worker keeps up to GREEN_MAX VMs and gives each one GREEN_QUANTUM
+ * instructions per round, taking on new jobs between rounds. stdout and
+ * stderr are replaced by streams into the buffers of whichever VM is
+ * running, so the output of each job still reaches its own client.
+ */
+void green_loop(serve_t *s, int listen_fd)
+{
+	cookie_io_functions_t out_io = {NULL, green_out_write, NULL, NULL};
+	cookie_io_functions_t err_io = {NULL, green_err_write, NULL, NULL};
+	sched_t *g;
+	FILE *out, *err;
+
+	g = calloc(1, sizeof(*g));
+	if (g == NULL)
+		exit(EXIT_FAILURE);
+	g->serve = s;
+	out = fopencookie(g, "w", out_io);
+	err = fopencookie(g, "w", err_io);
+	if (out == NULL || err == NULL)
+		exit(EXIT_FAILURE);
+	setvbuf(out, NULL, _IOFBF, BUFSIZ);
+	setvbuf(err, NULL, _IONBF, 0);
+	stdout = out;
+	stderr = err;
+	while (1)
+	{
+		green_accept(g, listen_fd);
+		green_round(g);
+	}
+}
+
+/**
+ * green_accept - Takes on the jobs waiting on the socket.
+ * @g: The scheduler.
+ * @listen_fd: The listening socket, non-blocking.
+ *
+ * Only waits when no VM can run (see green_wait). At most
+ * GREEN_ACCEPT jobs are taken at a time, so a burst of them never stalls
+ * the VMs already running for long.
+ */
+void green_accept(sched_t *g, int listen_fd)
+{
+	int i, c;
+
+	green_wait(g, listen_fd);
+	for (i = 0; i < GREEN_ACCEPT && g->n_run < GREEN_MAX; i++)
+	{
+		c = accept(listen_fd, NULL, NULL);
+		if (c == -1)
+			return;
+		green_start(g, c);
+	}
+}
+
+/**
+ * green_new - Takes a context off the free list, or allocates one.
+ * @g: The scheduler.
+ *
+ * Return: The context, with an empty stack bank and its own stdin
+ * buffer, or NULL if malloc fails.
+ */
+green_t *green_new(sched_t *g)
+{
+	green_t *t = g->free;
+
+	if (t != NULL)
+	{
+		g->free = t->next;
+		return (t);
+	}
+	t = calloc(1, sizeof(*t));
+	if (t == NULL)
+		return (NULL);
+	t->in = malloc(sizeof(*t->in));
+	vm.mem = 0;
+	if (t->in == NULL || init_stack(&t->stack) == EXIT_FAILURE)
+	{
+		free(t->in);
+		free(t);
+		return (NULL);
+	}
+	t->mem = vm.mem;
+	return (t);
+}
+
+/**
+ * green_start - Receives a job and queues a VM for it.
+ * @g: The scheduler.
+ * @c: The connection to the client.
+ *
+ * Description: The program comes from the worker's cache like for
+ * serve_job. A cache entry is only replaced while no VM runs it; a
+ * program whose entry is busy is decoded for the job alone. The VM runs
+ * in its client's working directory until its --timeout deadline.
+ */
+void green_start(sched_t *g, int c)
+{
+	unsigned long len;
+	int fds[SERVE_FDS], i, hit;
+	char *src;
+	green_t *t = NULL;
+	cache_ent_t *ent;
+
+	if (serve_recv_hdr(c, &len, fds) == EXIT_FAILURE)
+	{
+		close(c);
+		return;
+	}
+	src = malloc(len + 1);
+	if (src != NULL)
+		t = green_new(g);
+	if (t == NULL || read_full(c, src, len) == EXIT_FAILURE)
+	{
+		if (t != NULL)
+		{
+			t->next = g->free;
+			g->free = t;
+		}
+		free(src);
+		for (i = 0; i < SERVE_FDS; i++)
+			close(fds[i]);
+		close(c);
+		return;
+	}
+	t->conn = c;
+	t->out.fd = fds[0];
+	t->err.fd = fds[1];
+	input_reset(t->in, fds[2], 1);
+	t->waiting = 0;
+	t->dir = fds[3];
+	t->deadline = opts.timeout ? green_clock() + 1000 * opts.timeout : 0;
+	t->ip = 0;
+	t->rsp = 0;
+	t->status = EXIT_SUCCESS;
+	g->cur = t;
+	ent = serve_slot(g->serve, src, len, &hit);
+	if (fchdir(t->dir) == -1)
+	{
+		t->prog = NULL;
+		t->ent = NULL;
+		chdir_error();
+		free(src);
+	}
+	else if (hit || ent->users == 0)
+	{
+		t->prog = serve_lookup(g->serve, src, len);
+		t->ent = t->prog != NULL ? ent : NULL;
+	}
+	else
+	{
+		t->prog = &t->own;
+		t->ent = NULL;
+		if (load_program_mem(src, len, &t->own) == EXIT_FAILURE)
+			t->prog = NULL;
+		else
+			dce_trim(&t->own);
+		free(src);
+	}
+	if (t->ent != NULL)
+		t->ent->users++;
+	if (t->prog == NULL)
+	{
+		t->status = EXIT_FAILURE;
+		green_finish(g, t);
+	}
+	else
+		g->run[g->n_run++] = t;
+	g->cur = NULL;
+}
+
+/**
+ * green_finish - Sends a finished job its output and exit status, and
+ * puts its context on the free list.
+ * @g: The scheduler.
+ * @t: The context of the job; g->cur.
+ */
+void green_finish(sched_t *g, green_t *t)
+{
+	if (t->status == EXIT_SUCCESS && t->prog != NULL &&
+	    t->prog->nul_tail)
+		t->status = malloc_error();
+	fflush(stdout);
+	clearerr(stdout);
+	clearerr(stderr);
+	green_flush(&t->err);
+	green_flush(&t->out);
+	close(t->out.fd);
+	close(t->err.fd);
+	close(t->in->fd);
+	close(t->dir);
+	write_full(t->conn, &t->status, sizeof(t->status));
+	close(t->conn);
+	if (t->ent != NULL)
+		t->ent->users--;
+	else
+		free_program(&t->own);
+	vm.mem = t->mem;
+	if (serve_reset(&t->stack) == EXIT_FAILURE)
+	{
+		free(t->ret);
+		free(t->out.data);
+		free(t->err.data);
+		free(t->in);
+		free(t);
+		return;
+	}
+	t->mem = vm.mem;
+	t->next = g->free;
+	g->free = t;
+}
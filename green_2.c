@@ -0,0 +1,107 @@
+#include "monty.h"
+#include <string.h>
+
+int green_slice(green_t *t);
+void green_round(sched_t *g);
+
+/**
+ * green_slice - Runs a VM for up to GREEN_QUANTUM instructions.
+ * @t: The context of the VM.
+ *
+ * Description: The context is loaded into vm, run like exec_program and
+ * saved back; only the live part of the return stack is copied each way.
+ * --jit does not apply here, as native code cannot yield. A read on a
+ * stdin with nothing to read yet ends the slice early, before the read,
+ * and marks the VM as waiting (see green_wait). The working directory is
+ * the client's for the length of the slice.
+ *
+ * Return: Non-zero once the program has ended or failed.
+ */
+int green_slice(green_t *t)
+{
+	prog_t *prog = t->prog;
+	instr_t *in;
+	size_t n, *ret;
+
+	vm.prog = prog;
+	vm.ip = t->ip;
+	vm.status = t->status;
+	vm.mem = t->mem;
+	vm.rsp = t->rsp;
+	vm.in = t->in;
+	if (fchdir(t->dir) == -1)
+	{
+		t->status = chdir_error();
+		return (1);
+	}
+	memcpy(vm.ret, t->ret, sizeof(size_t) * t->rsp);
+	for (n = GREEN_QUANTUM; n > 0 && vm.ip < prog->len; n--)
+	{
+		in = &prog->code[vm.ip++];
+		vm.arg = in->arg;
+		op_table[in->op].f(&t->stack, in->line);
+		if (vm.status != EXIT_SUCCESS)
+			break;
+	}
+	t->waiting = vm.status == VM_WAIT;
+	if (t->waiting)
+		vm.status = EXIT_SUCCESS;
+	t->ip = vm.ip;
+	t->status = vm.status;
+	t->mem = vm.mem;
+	if (vm.rsp > t->ret_cap)
+	{
+		n = t->ret_cap ? t->ret_cap : 16;
+		while (n < vm.rsp)
+			n *= 2;
+		ret = realloc(t->ret, sizeof(size_t) * n);
+		if (ret == NULL)
+		{
+			t->status = malloc_error();
+			return (1);
+		}
+		t->ret = ret;
+		t->ret_cap = n;
+	}
+	memcpy(t->ret, vm.ret, sizeof(size_t) * vm.rsp);
+	t->rsp = vm.rsp;
+	return (t->ip >= prog->len || t->status != EXIT_SUCCESS);
+}
+
+/**
+ * green_round - Gives every running VM one slice, in turn.
+ * @g: The scheduler.
+ *
+ * VMs that finish, or run past their --timeout deadline, are answered and
+ * dropped from the run queue; the others keep their order, so every job
+ * gets the same share of each round.
+ */
+void green_round(sched_t *g)
+{
+	size_t i, kept = 0;
+	unsigned long now = green_clock();
+	green_t *t;
+
+	for (i = 0; i < g->n_run; i++)
+	{
+		t = g->run[i];
+		g->cur = t;
+		if (green_slice(t))
+			green_finish(g, t);
+		else if (t->deadline != 0 && now >= t->deadline)
+		{
+			t->status = timeout_error();
+			green_finish(g, t);
+		}
+		else
+		{
+			fflush(stdout);
+			clearerr(stdout);
+			g->run[kept++] = t;
+		}
+	}
+	g->n_run = kept;
+	g->cur = NULL;
+	if (fchdir(g->serve->home) == -1)
+		exit(EXIT_FAILURE);
+}
@@ -0,0 +1,53 @@
+#include "monty.h"
+#include <poll.h>
+#include <time.h>
+
+void green_wait(sched_t *g, int listen_fd);
+unsigned long green_clock(void);
+
+/**
+ * green_wait - Sleeps until a job arrives, the stdin of a waiting VM is
+ * ready or a --timeout deadline comes, when no VM can run.
+ * @g: The scheduler.
+ * @listen_fd: The listening socket.
+ *
+ * Returns at once if any VM is not waiting for its stdin.
+ */
+void green_wait(sched_t *g, int listen_fd)
+{
+	struct pollfd p[GREEN_MAX + 1];
+	unsigned long now = green_clock(), left;
+	size_t i;
+	int timeout = -1;
+	green_t *t;
+
+	p[0].fd = listen_fd;
+	p[0].events = POLLIN;
+	for (i = 0; i < g->n_run; i++)
+	{
+		t = g->run[i];
+		if (!t->waiting)
+			return;
+		p[i + 1].fd = t->in->fd;
+		p[i + 1].events = POLLIN;
+		if (t->deadline == 0)
+			continue;
+		left = t->deadline > now ? t->deadline - now : 0;
+		if (timeout == -1 || left < (unsigned long)timeout)
+			timeout = left;
+	}
+	poll(p, g->n_run + 1, timeout);
+}
+
+/**
+ * green_clock - Reads the clock --timeout deadlines are set on.
+ *
+ * Return: Milliseconds of CLOCK_MONOTONIC.
+ */
+unsigned long green_clock(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ts.tv_sec * 1000UL + ts.tv_nsec / 1000000);
+}
@@ -0,0 +1,97 @@
+#include "monty.h"
+#include <string.h>
+
+int green_flush(green_buf_t *b);
+int green_put(green_buf_t *b, const char *buf, size_t size);
+ssize_t green_out_write(void *cookie, const char *buf, size_t size);
+ssize_t green_err_write(void *cookie, const char *buf, size_t size);
+
+/**
+ * green_flush - Writes the buffered output of a VM to its client.
+ * @b: The buffer.
+ *
+ * The output is dropped if the client has gone away.
+ *
+ * Return: EXIT_SUCCESS, or EXIT_FAILURE if it could not be written.
+ */
+int green_flush(green_buf_t *b)
+{
+	int status = write_full(b->fd, b->data, b->len);
+
+	b->len = 0;
+	return (status);
+}
+
+/**
+ * green_put - Buffers output of a VM, writing it out past GREEN_OUT bytes.
+ * @b: The buffer.
+ * @buf: The data.
+ * @size: Number of bytes.
+ *
+ * Return: EXIT_SUCCESS, or EXIT_FAILURE on error.
+ */
+int green_put(green_buf_t *b, const char *buf, size_t size)
+{
+	size_t cap;
+	char *data;
+
+	if (b->len + size > GREEN_OUT)
+	{
+		if (green_flush(b) == EXIT_FAILURE)
+			return (EXIT_FAILURE);
+		if (size >= GREEN_OUT)
+			return (write_full(b->fd, buf, size));
+	}
+	if (b->len + size > b->cap)
+	{
+		cap = b->cap ? b->cap : 256;
+		while (cap < b->len + size)
+			cap *= 2;
+		data = realloc(b->data, cap);
+		if (data == NULL)
+			return (EXIT_FAILURE);
+		b->data = data;
+		b->cap = cap;
+	}
+	memcpy(b->data + b->len, buf, size);
+	b->len += size;
+	return (EXIT_SUCCESS);
+}
+
+/**
+ * green_out_write - Writes stdout data to the running VM's buffer.
+ * @cookie: The scheduler.
+ * @buf: The data.
+ * @size: Number of bytes.
+ *
+ * Return: @size, or 0 on error. Output outside a VM is dropped.
+ */
+ssize_t green_out_write(void *cookie, const char *buf, size_t size)
+{
+	sched_t *g = cookie;
+
+	if (g->cur == NULL)
+		return (size);
+	if (green_put(&g->cur->out, buf, size) == EXIT_FAILURE)
+		return (0);
+	return (size);
+}
+
+/**
+ * green_err_write - Writes stderr data to the running VM's buffer.
+ * @cookie: The scheduler.
+ * @buf: The data.
+ * @size: Number of bytes.
+ *
+ * Return: @size, or 0 on error. Output outside a VM is dropped.
+ */
+ssize_t green_err_write(void *cookie, const char *buf, size_t size)
+{
+	sched_t *g = cookie;
+
+	if (g->cur == NULL)
+		return (size);
+	if (green_put(&g->cur->err, buf, size) == EXIT_FAILURE)
+		return (0);
+	return (size);
+}
@@ -0,0 +1,230 @@
+/* fopencookie is a GNU extension */
+#define _GNU_SOURCE
+#include "monty.h"
+#include <string.h>
+
+int inc_run(prog_t *prog, stack_t **stack);
+int inc_prefix(inc_t *inc, prog_t *prog);
+void inc_snap(inc_t *inc, stack_t *stack);
+ssize_t inc_out_write(void *cookie, const char *buf, size_t size);
+void inc_free(inc_t *inc);
+
+/**
+ * inc_run - Runs a program with --incremental.
+ * @prog: The decoded program.
+ * @stack: The stack_t the program operates on.
+ *
+ * Description: While execution is still straight-line, the VM state is
+ * snapshotted every so often, keyed by a hash of the program up to that
+ * point; the state then depends on nothing else. Snapshots hold no map,
+ * so they also stop at the first store. A later run whose source
+ * starts the same resumes from the last matching snapshot and prints the
+ * output cached with it instead of replaying the prefix.
+ *
+ * Return: EXIT_SUCCESS, or the exit code of the first opcode that failed.
+ */
+int inc_run(prog_t *prog, stack_t **stack)
+{
+	cookie_io_functions_t io = {NULL, inc_out_write, NULL, NULL};
+	inc_t inc;
+	instr_t *in;
+	FILE *out;
+
+	memset(&inc, 0, sizeof(inc));
+	vm.prog = prog;
+	vm.ip = 0;
+	vm.rsp = 0;
+	vm.status = EXIT_SUCCESS;
+	if (inc_prefix(&inc, prog) == EXIT_FAILURE)
+	{
+		free(inc.prefix);
+		return (exec_program(prog, stack));
+	}
+	inc.recording = 1;
+	inc.every = INC_EVERY;
+	fflush(stdout);
+	out = fopencookie(&inc, "w", io);
+	if (out != NULL)
+	{
+		setvbuf(out, NULL, isatty(STDOUT_FILENO) ? _IOLBF : _IOFBF,
+			BUFSIZ);
+		stdout = out;
+	}
+	inc_load(&inc, stack, prog);
+	inc.next = vm.ip + inc.every;
+	while (vm.ip < prog->len && vm.status == EXIT_SUCCESS)
+	{
+		if (vm.ip >= inc.next && inc.recording)
+			inc_snap(&inc, *stack);
+		in = &prog->code[vm.ip++];
+		if (op_table[in->op].operand == OPND_LABEL ||
+		    in->op == OP_BF_IN || in->op == OP_READ ||
+		    in->op == OP_READALL || in->op == OP_LOAD ||
+		    in->op == OP_SAVE || in->op == OP_STORE)
+			inc.recording = 0;
+		vm.arg = in->arg;
+		op_table[in->op].f(stack, in->line);
+	}
+	fflush(stdout);
+	inc_save(&inc);
+	inc_free(&inc);
+	return (vm.status);
+}
+
+/**
+ * inc_prefix - Computes the prefix hash of every instruction boundary,
+ * and the session file of the script.
+ * @inc: The run state.
+ * @prog: The decoded program.
+ *
+ * Boundary k is keyed by a rolling hash of the opcodes and operands of
+ * instructions 0 to k - 1, so edits to comments, blank lines or anything
+ * after it do not invalidate its snapshot. The literals of pushs and pushn
+ * are hashed along with their pool offset.
+ *
+ * Return: EXIT_SUCCESS, or EXIT_FAILURE if there is no usable cache.
+ */
+int inc_prefix(inc_t *inc, prog_t *prog)
+{
+	char *script = realpath(opts.script, NULL);
+	unsigned long hash = 14695981039346656037UL;
+	size_t i;
+	int status, *lit;
+
+	if (script == NULL)
+		return (EXIT_FAILURE);
+	status = cache_path(inc->path, sizeof(inc->path),
+			    hash_bytes(script, strlen(script)), "mi");
+	free(script);
+	inc->prefix = malloc(sizeof(unsigned long) * (prog->len + 1));
+	if (status == EXIT_FAILURE || inc->prefix == NULL)
+		return (EXIT_FAILURE);
+	inc->prefix[0] = hash;
+	for (i = 0; i < prog->len; i++)
+	{
+		hash = (hash ^ (unsigned int)prog->code[i].op) *
+			1099511628211UL;
+		hash = (hash ^ (unsigned int)prog->code[i].arg) *
+			1099511628211UL;
+		if (op_table[prog->code[i].op].operand == OPND_STRING ||
+		    op_table[prog->code[i].op].operand == OPND_LIST)
+		{
+			lit = prog->pool + prog->code[i].arg;
+			hash = (hash ^ hash_bytes((char *)lit,
+				 sizeof(int) * (lit[0] + 1))) * 1099511628211UL;
+		}
+		inc->prefix[i + 1] = hash;
+	}
+	return (EXIT_SUCCESS);
+}
+
+/**
+ * inc_snap - Snapshots the VM before the instruction at vm.ip.
+ * @inc: The run state.
+ * @stack: The selected stack_t.
+ *
+ * Once INC_SNAPS snapshots are kept, every other one is dropped and the
+ * interval doubles, so they stay spread over the whole run.
+ */
+void inc_snap(inc_t *inc, stack_t *stack)
+{
+	stack_t *bank = stack - stack->id;
+	inc_snap_t *snap;
+	unsigned long info[2], size = sizeof(unsigned long), i, first;
+	unsigned char *p;
+
+	inc->next = vm.ip + inc->every;
+	for (i = 0; i < STACK_BANK; i++)
+		size += sizeof(info) + bank[i].len * sizeof(int);
+	if (size > INC_MAX_VALS * sizeof(int))
+		return;
+	fflush(stdout);
+	if (inc->n == INC_SNAPS)
+	{
+		for (i = 0; i < INC_SNAPS; i += 2)
+			free(inc->snaps[i + 1].data);
+		for (i = 0; i < INC_SNAPS / 2; i++)
+			inc->snaps[i] = inc->snaps[i * 2];
+		inc->n = INC_SNAPS / 2;
+		inc->every *= 2;
+		inc->next = vm.ip + inc->every;
+	}
+	snap = &inc->snaps[inc->n];
+	snap->data = malloc(size);
+	if (snap->data == NULL)
+		return;
+	snap->hash = inc->prefix[vm.ip];
+	snap->ip = vm.ip;
+	snap->out = inc->out_len;
+	snap->size = size;
+	info[0] = stack->id;
+	memcpy(snap->data, info, sizeof(unsigned long));
+	p = snap->data + sizeof(unsigned long);
+	for (i = 0; i < STACK_BANK; i++)
+	{
+		info[0] = bank[i].mode;
+		info[1] = bank[i].len;
+		memcpy(p, info, sizeof(info));
+		p += sizeof(info);
+		first = bank[i].cap - bank[i].head;
+		if (first > bank[i].len)
+			first = bank[i].len;
+		memcpy(p, bank[i].vals + bank[i].head, first * sizeof(int));
+		memcpy(p + first * sizeof(int), bank[i].vals,
+		       (bank[i].len - first) * sizeof(int));
+		p += bank[i].len * sizeof(int);
+	}
+	inc->n++;
+}
+
+/**
+ * inc_out_write - Writes stdout data, keeping a copy while recording.
+ * @cookie: The run state.
+ * @buf: The data.
+ * @size: Number of bytes.
+ *
+ * Return: @size, or 0 on error.
+ */
+ssize_t inc_out_write(void *cookie, const char *buf, size_t size)
+{
+	inc_t *inc = cookie;
+	char *out;
+
+	if (write_full(STDOUT_FILENO, buf, size) == EXIT_FAILURE)
+		return (0);
+	if (!inc->recording)
+		return (size);
+	if (inc->out_len + size > INC_MAX_OUT)
+	{
+		inc->recording = 0;
+		return (size);
+	}
+	if (inc->out_len + size > inc->out_cap)
+	{
+		out = realloc(inc->out, (inc->out_len + size) * 2);
+		if (out == NULL)
+		{
+			inc->recording = 0;
+			return (size);
+		}
+		inc->out = out;
+		inc->out_cap = (inc->out_len + size) * 2;
+	}
+	memcpy(inc->out + inc->out_len, buf, size);
+	inc->out_len += size;
+	return (size);
+}
+
+/**
+ * inc_free - Frees the state of an --incremental run.
+ * @inc: The run state.
+ */
+void inc_free(inc_t *inc)
+{
+	int i;
+
+	for (i = 0; i < inc->n; i++)
+		free(inc->snaps[i].data);
+	free(inc->prefix);
+	free(inc->out);
+}
@@ -0,0 +1,191 @@
+#include "monty.h"
+#include <string.h>
+#include <stddef.h>
+#include <fcntl.h>
+
+void inc_load(inc_t *inc, stack_t **stack, prog_t *prog);
+int inc_restore(inc_snap_t *snap, stack_t **stack);
+void inc_save(inc_t *inc);
+unsigned long inc_sum(inc_t *inc, int n, char *out, size_t len);
+
+/**
+ * inc_load - Resumes from the last snapshot of the previous run whose
+ * prefix hash is unchanged.
+ * @inc: The run state.
+ * @stack: Pointer to the program's empty stack bank; set to the stack
+ * that was selected.
+ * @prog: The decoded program.
+ *
+ * Description: The snapshots up to that one are kept for the next run,
+ * and the output cached with it is printed. A missing or corrupt session
+ * file just starts the run from the beginning.
+ */
+void inc_load(inc_t *inc, stack_t **stack, prog_t *prog)
+{
+	inc_hdr_t hdr;
+	int fd, i, status;
+	char *out = NULL;
+
+	fd = open(inc->path, O_RDONLY);
+	if (fd == -1)
+		return;
+	status = read_full(fd, &hdr, sizeof(hdr));
+	if (status == EXIT_FAILURE || memcmp(hdr.magic, INC_MAGIC, 8) != 0 ||
+	    hdr.version != CACHE_VERSION || hdr.n > INC_SNAPS ||
+	    hdr.every < INC_EVERY || hdr.out > INC_MAX_OUT ||
+	    read_full(fd, inc->snaps,
+		      hdr.n * sizeof(inc_snap_t)) == EXIT_FAILURE)
+	{
+		hdr.n = 0;
+		status = EXIT_FAILURE;
+	}
+	for (i = 0; i < (int)hdr.n && status == EXIT_SUCCESS; i++)
+	{
+		inc->snaps[i].data = malloc(inc->snaps[i].size + 1);
+		inc->n = i + 1;
+		if (inc->snaps[i].size > INC_MAX_VALS * sizeof(int) ||
+		    inc->snaps[i].out > hdr.out || inc->snaps[i].data == NULL)
+			status = EXIT_FAILURE;
+		else
+			status = read_full(fd, inc->snaps[i].data,
+					   inc->snaps[i].size);
+	}
+	if (status == EXIT_SUCCESS)
+		out = malloc(hdr.out + 1);
+	if (out == NULL || read_full(fd, out, hdr.out) == EXIT_FAILURE ||
+	    inc_sum(inc, inc->n, out, hdr.out) != hdr.sum)
+		status = EXIT_FAILURE;
+	close(fd);
+	while (inc->n > 0 && (status == EXIT_FAILURE ||
+	       inc->snaps[inc->n - 1].ip >= prog->len ||
+	       inc->snaps[inc->n - 1].hash !=
+	       inc->prefix[inc->snaps[inc->n - 1].ip]))
+		free(inc->snaps[--inc->n].data);
+	if (inc->n > 0 &&
+	    inc_restore(&inc->snaps[inc->n - 1], stack) == EXIT_SUCCESS)
+	{
+		inc->every = hdr.every;
+		fwrite(out, 1, inc->snaps[inc->n - 1].out, stdout);
+	}
+	else
+	{
+		while (inc->n > 0)
+			free(inc->snaps[--inc->n].data);
+		for (i = 0; i < STACK_BANK; i++)
+		{
+			(*stack)[i].head = 0;
+			(*stack)[i].len = 0;
+			(*stack)[i].mode = 0;
+		}
+	}
+	free(out);
+}
+
+/**
+ * inc_restore - Restores the VM from a snapshot.
+ * @snap: The snapshot.
+ * @stack: Pointer to the program's empty stack bank; set to the stack
+ * that was selected.
+ *
+ * Return: EXIT_SUCCESS, or EXIT_FAILURE if the snapshot is malformed.
+ */
+int inc_restore(inc_snap_t *snap, stack_t **stack)
+{
+	unsigned long info[2], left = snap->size;
+	unsigned char *p = snap->data;
+	int i;
+
+	if (left < sizeof(unsigned long))
+		return (EXIT_FAILURE);
+	memcpy(info, p, sizeof(unsigned long));
+	if (info[0] >= STACK_BANK)
+		return (EXIT_FAILURE);
+	p += sizeof(unsigned long);
+	left -= sizeof(unsigned long);
+	for (i = 0; i < STACK_BANK; i++)
+	{
+		if (left < sizeof(info))
+			return (EXIT_FAILURE);
+		memcpy(info, p, sizeof(info));
+		p += sizeof(info);
+		left -= sizeof(info);
+		if ((info[0] != STACK && info[0] != QUEUE) ||
+		    info[1] > left / sizeof(int))
+			return (EXIT_FAILURE);
+		while ((*stack)[i].cap < info[1])
+			if (stack_grow(*stack + i) != EXIT_SUCCESS)
+				return (EXIT_FAILURE);
+		memcpy((*stack)[i].vals, p, info[1] * sizeof(int));
+		(*stack)[i].head = 0;
+		(*stack)[i].len = info[1];
+		(*stack)[i].mode = info[0];
+		p += info[1] * sizeof(int);
+		left -= info[1] * sizeof(int);
+	}
+	memcpy(info, snap->data, sizeof(unsigned long));
+	*stack += info[0];
+	vm.ip = snap->ip;
+	return (EXIT_SUCCESS);
+}
+
+/**
+ * inc_save - Writes the session file for the next run.
+ * @inc: The run state.
+ *
+ * The file is written to a temporary file that is renamed over the
+ * previous one, so concurrent runs of a script never see half of one.
+ */
+void inc_save(inc_t *inc)
+{
+	inc_hdr_t hdr;
+	char tmp[4200];
+	int fd, i, status;
+
+	memset(&hdr, 0, sizeof(hdr));
+	memcpy(hdr.magic, INC_MAGIC, 8);
+	hdr.version = CACHE_VERSION;
+	hdr.n = inc->n;
+	hdr.every = inc->every;
+	hdr.out = inc->n > 0 ? inc->snaps[inc->n - 1].out : 0;
+	hdr.sum = inc_sum(inc, inc->n, inc->out, hdr.out);
+	snprintf(tmp, sizeof(tmp), "%s.%ld.tmp", inc->path, (long)getpid());
+	fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+	if (fd == -1)
+		return;
+	status = write_full(fd, &hdr, sizeof(hdr));
+	if (status == EXIT_SUCCESS)
+		status = write_full(fd, inc->snaps,
+				    inc->n * sizeof(inc_snap_t));
+	for (i = 0; i < inc->n && status == EXIT_SUCCESS; i++)
+		status = write_full(fd, inc->snaps[i].data, inc->snaps[i].size);
+	if (status == EXIT_SUCCESS)
+		status = write_full(fd, inc->out, hdr.out);
+	if (close(fd) == -1 || status == EXIT_FAILURE ||
+	    rename(tmp, inc->path) == -1)
+		unlink(tmp);
+}
+
+/**
+ * inc_sum - Checksums the snapshots and output of a session file.
+ * @inc: The run state.
+ * @n: Number of snapshots.
+ * @out: The output.
+ * @len: Length of @out.
+ *
+ * Return: The checksum.
+ */
+unsigned long inc_sum(inc_t *inc, int n, char *out, size_t len)
+{
+	unsigned long sum;
+	int i;
+
+	sum = hash_bytes(out, len);
+	for (i = 0; i < n; i++)
+	{
+		sum = sum * 31 + hash_bytes((char *)&inc->snaps[i],
+					    offsetof(inc_snap_t, data));
+		sum = sum * 31 + hash_bytes((char *)inc->snaps[i].data,
+					    inc->snaps[i].size);
+	}
+	return (sum);
+}
@@ -0,0 +1,137 @@
+#include "monty.h"
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+
+int input_fill(input_t *in);
+int input_int(input_t *in, int *n);
+void input_reset(input_t *in, int fd, int yield);
+
+/**
+ * input_fill - Reads more of stdin into the input buffer.
+ * @in: The input buffer.
+ *
+ * Bytes from the integer being parsed on are moved to the front first. A
+ * read error ends the input, as getchar would. With @in->yield, nothing
+ * is read unless stdin is ready, so a --green VM never waits in read; an
+ * integer longer than the buffer is the exception.
+ *
+ * Return: 1 if bytes were added, 0 at the end of the input, or
+ * INPUT_WAIT if stdin has nothing yet.
+ */
+int input_fill(input_t *in)
+{
+	struct pollfd p;
+	size_t room, keep = in->mark;
+	ssize_t got;
+	int whole = 1;
+
+	if (in->eof)
+		return (0);
+	if (in->len - keep == INPUT_BUF)
+	{
+		keep = in->pos;
+		whole = 0;
+	}
+	memmove(in->buf, in->buf + keep, in->len - keep);
+	in->len -= keep;
+	in->pos -= keep;
+	in->mark = 0;
+	room = INPUT_BUF - in->len;
+	p.fd = in->fd;
+	p.events = POLLIN;
+	if (in->yield && whole && poll(&p, 1, 0) == 0)
+		return (INPUT_WAIT);
+	do
+		got = read(in->fd, in->buf + in->len, room);
+	while (got == -1 && errno == EINTR);
+	if (got <= 0)
+	{
+		in->eof = 1;
+		in->buf[in->len] = '\0';
+		return (0);
+	}
+	in->len += got;
+	in->off += got;
+	in->buf[in->len] = '\0';
+	return (1);
+}
+
+/**
+ * input_int - Parses the next integer of the input.
+ * @in: The input buffer.
+ * @n: Where to store the integer.
+ *
+ * Description: Integers are decimal, with an optional sign, and separated
+ * by whitespace; like push, out of range ones wrap around. The NUL after
+ * the buffered bytes stops the digit loop, so it tests one range per
+ * byte and only checks for the end of the buffer once per run of digits.
+ * An integer cut short by INPUT_WAIT is left unparsed for the next call.
+ *
+ * Return: 1 on success, 0 at the end of the input, -1 if the next word is
+ * not an integer, or INPUT_WAIT.
+ */
+int input_int(input_t *in, int *n)
+{
+	unsigned int u = 0, d, digits = 0;
+	unsigned char c;
+	int neg, got;
+
+	for (;;)
+	{
+		c = in->buf[in->pos];
+		while (c == ' ' || (c >= '\t' && c <= '\r'))
+			c = in->buf[++in->pos];
+		in->mark = in->pos;
+		if (in->pos < in->len)
+			break;
+		got = input_fill(in);
+		if (got != 1)
+			return (got);
+	}
+	neg = c == '-';
+	in->pos += (c == '-' || c == '+');
+	for (;;)
+	{
+		while ((d = (unsigned char)in->buf[in->pos] - '0') < 10)
+		{
+			u = u * 10 + d;
+			in->pos++;
+			digits++;
+		}
+		if (in->pos < in->len)
+			break;
+		got = input_fill(in);
+		if (got == INPUT_WAIT)
+		{
+			in->pos = in->mark;
+			return (INPUT_WAIT);
+		}
+		if (got == 0)
+			break;
+	}
+	c = in->buf[in->pos];
+	if (digits == 0 || (in->pos < in->len && c != ' ' &&
+			    (c < '\t' || c > '\r')))
+		return (-1);
+	*n = (int)(neg ? 0 - u : u);
+	return (1);
+}
+
+/**
+ * input_reset - Discards buffered input and reads from another descriptor.
+ * @in: The input buffer.
+ * @fd: The descriptor to read from.
+ * @yield: Non-zero to get INPUT_WAIT rather than wait for @fd.
+ */
+void input_reset(input_t *in, int fd, int yield)
+{
+	in->pos = 0;
+	in->len = 0;
+	in->mark = 0;
+	in->eof = 0;
+	in->buf[0] = '\0';
+	in->fd = fd;
+	in->off = 0;
+	in->yield = yield;
+}
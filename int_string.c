@@ -5,6 +5,7 @@ unsigned int _abs(int);
 int get_numbase_len(unsigned int num, unsigned int base);
 void fill_numbase_buff(unsigned int num, unsigned int base,
 		       char *buff, int buff_size);
+int is_int_str(char *str);
 
 /**
  * get_int - Converts an integer to a character pointer
@@ -120,3 +121,25 @@ void fill_numbase_buff(unsigned int num, unsigned int base,
 		i--;
 	}
 }
+
+/**
+ * is_int_str - Checks that a token spells a (possibly negative) integer.
+ * @str: The token to check.
+ *
+ * A lone leading '-' is accepted, matching what monty_push always did.
+ *
+ * Return: 1 if every character is a digit (after an optional '-'), else 0.
+ */
+int is_int_str(char *str)
+{
+	int i;
+
+	for (i = 0; str[i]; i++)
+	{
+		if (str[i] == '-' && i == 0)
+			continue;
+		if (str[i] < '0' || str[i] > '9')
+			return (0);
+	}
+	return (1);
+}
@@ -0,0 +1,166 @@
+#include "monty.h"
+#include <string.h>
+#include <sys/mman.h>
+
+int jit_exec(prog_t *prog, stack_t **stack);
+int jit_compile(prog_t *prog, jit_t *j);
+long jit_fallback(stack_t **stack, size_t ip);
+void jit_free(jit_t *j);
+void jit_finish(jit_t *j, prog_t *prog);
+
+/**
+ * jit_exec - Runs a decoded program as native code.
+ * @prog: The decoded program.
+ * @stack: The stack_t the program operates on.
+ *
+ * Return: The exit status of the program, or -1 if it could not be
+ * compiled, in which case the caller interprets it instead.
+ */
+int jit_exec(prog_t *prog, stack_t **stack)
+{
+	jit_t j;
+	int (*fn)(stack_t **stack);
+	int status = -1;
+
+	if (jit_compile(prog, &j) == EXIT_SUCCESS)
+	{
+		vm.prog = prog;
+		vm.rsp = 0;
+		vm.status = EXIT_SUCCESS;
+		memcpy(&fn, &j.code, sizeof(fn));
+		status = fn(stack);
+		vm.status = status;
+	}
+	jit_free(&j);
+	return (status);
+}
+
+/**
+ * jit_compile - Translates a decoded program into x86-64 code.
+ * @prog: The decoded program.
+ * @j: The JIT state to fill in; release it with jit_free.
+ *
+ * Description: Each instruction becomes a code template working on the
+ * stack_t ring buffer through registers (rbx the stack_t, r12 its values,
+ * r13 the head, r14 the length, r15 the index mask). Failing checks branch
+ * to out-of-line stubs calling the usual error functions, and opcodes
+ * without a template call back into the interpreter.
+ *
+ * Return: EXIT_SUCCESS, or EXIT_FAILURE if the program cannot be compiled.
+ */
+int jit_compile(prog_t *prog, jit_t *j)
+{
+#if defined(__x86_64__)
+	size_t i;
+
+	memset(j, 0, sizeof(*j));
+	if (prog->len > 0x7fffff)
+		return (EXIT_FAILURE);
+	j->cap = (prog->len + 1) * 256 + 1024;
+	j->code = mmap(NULL, j->cap, PROT_READ | PROT_WRITE,
+		       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (j->code == MAP_FAILED)
+	{
+		j->code = NULL;
+		return (EXIT_FAILURE);
+	}
+	j->addr = malloc(sizeof(size_t) * (prog->len + 1));
+	j->table = malloc(sizeof(size_t) * (prog->len + 1));
+	if (j->addr == NULL || j->table == NULL)
+		return (EXIT_FAILURE);
+
+	jit_prologue(j);
+	for (i = 0; i < prog->len; i++)
+	{
+		j->addr[i] = j->len;
+		jit_instr(j, prog, i);
+	}
+	j->addr[prog->len] = j->len;
+	JIT_EMIT(j, "\x31\xc0");
+	jit_jump(j, "\xe9", 1, JIT_AT, j->epilogue, 0);
+	jit_finish(j, prog);
+	if (j->failed || mprotect(j->code, j->cap, PROT_READ | PROT_EXEC) == -1)
+		return (EXIT_FAILURE);
+	return (EXIT_SUCCESS);
+#else
+	memset(j, 0, sizeof(*j));
+	(void)prog;
+	return (EXIT_FAILURE);
+#endif
+}
+
+/**
+ * jit_fallback - Runs one instruction through the interpreter for the JIT.
+ * @stack: The stack_t the program operates on.
+ * @ip: Index of the instruction.
+ *
+ * Return: Index of the next instruction, or -1 if the opcode failed.
+ */
+long jit_fallback(stack_t **stack, size_t ip)
+{
+	instr_t *in = &vm.prog->code[ip];
+
+	vm.ip = ip + 1;
+	vm.arg = in->arg;
+	op_table[in->op].f(stack, in->line);
+	if (vm.status != EXIT_SUCCESS)
+		return (-1);
+	return ((long)vm.ip);
+}
+
+/**
+ * jit_free - Releases the code buffer and tables of the JIT.
+ * @j: The JIT state.
+ */
+void jit_free(jit_t *j)
+{
+	if (j->code != NULL)
+		munmap(j->code, j->cap);
+	free(j->addr);
+	free(j->table);
+	free(j->fix);
+	memset(j, 0, sizeof(*j));
+}
+
+/**
+ * jit_finish - Emits the error stubs and patches every pending rel32.
+ * @j: The JIT state, with all instructions emitted.
+ * @prog: The program being compiled.
+ *
+ * Each stub loads the line number (and opcode name) and calls the same
+ * error function the interpreter would, then returns its status.
+ */
+void jit_finish(jit_t *j, prog_t *prog)
+{
+	size_t i, target;
+	jit_fix_t *f;
+
+	for (i = 0; i < j->n_fix && !j->failed; i++)
+	{
+		f = &j->fix[i];
+		target = f->kind == JIT_FIX_IP ? j->addr[f->value] : j->len;
+		jit_imm_at(j, f->pos, target - (f->pos + 4));
+		if (f->kind == JIT_FIX_IP)
+			continue;
+		JIT_EMIT(j, "\xbf");
+		jit_imm(j, f->line, 4);
+		if (f->kind == JIT_FIX_SHORT || f->kind == JIT_FIX_EMPTY)
+		{
+			JIT_EMIT(j, "\x48\xbe");
+			jit_imm(j, (size_t)op_table[f->value].opcode, 8);
+		}
+		if (f->kind == JIT_FIX_POP)
+			jit_call(j, (size_t)pop_error);
+		else if (f->kind == JIT_FIX_PINT)
+			jit_call(j, (size_t)pint_error);
+		else if (f->kind == JIT_FIX_SHORT)
+			jit_call(j, (size_t)short_stack_error);
+		else if (f->kind == JIT_FIX_DIV)
+			jit_call(j, (size_t)div_error);
+		else
+			jit_call(j, (size_t)empty_stack_error);
+		jit_jump(j, "\xe9", 1, JIT_AT, j->epilogue, 0);
+	}
+	for (i = 0; i <= prog->len; i++)
+		j->table[i] = (size_t)(j->code + j->addr[i]);
+}
@@ -0,0 +1,99 @@
+#include "monty.h"
+#include <string.h>
+
+void jit_emit(jit_t *j, const char *bytes, size_t n);
+void jit_imm(jit_t *j, size_t value, size_t n);
+void jit_imm_at(jit_t *j, size_t pos, size_t value);
+void jit_mem(jit_t *j, const char *op, size_t n, int reg, int index);
+void jit_rbx(jit_t *j, const char *op, size_t n, size_t offset);
+
+/**
+ * jit_emit - Appends raw bytes to the JIT code buffer.
+ * @j: The JIT state.
+ * @bytes: The machine code bytes.
+ * @n: Number of bytes.
+ *
+ * Overflowing the buffer marks the compilation as failed.
+ */
+void jit_emit(jit_t *j, const char *bytes, size_t n)
+{
+	if (j->failed || j->len + n > j->cap)
+	{
+		j->failed = 1;
+		return;
+	}
+	memcpy(j->code + j->len, bytes, n);
+	j->len += n;
+}
+
+/**
+ * jit_imm - Appends a little-endian immediate to the JIT code buffer.
+ * @j: The JIT state.
+ * @value: The immediate; only its low @n bytes are emitted.
+ * @n: Size of the immediate in bytes (1, 4 or 8).
+ */
+void jit_imm(jit_t *j, size_t value, size_t n)
+{
+	char b[8];
+	size_t i;
+
+	for (i = 0; i < n; i++)
+	{
+		b[i] = (char)(value & 0xff);
+		value >>= 8;
+	}
+	jit_emit(j, b, n);
+}
+
+/**
+ * jit_imm_at - Overwrites a 32-bit immediate already in the buffer.
+ * @j: The JIT state.
+ * @pos: Offset of the immediate.
+ * @value: The new value; only its low four bytes are written.
+ */
+void jit_imm_at(jit_t *j, size_t pos, size_t value)
+{
+	size_t i;
+
+	if (j->failed)
+		return;
+	for (i = 0; i < 4; i++)
+	{
+		j->code[pos + i] = (unsigned char)(value & 0xff);
+		value >>= 8;
+	}
+}
+
+/**
+ * jit_mem - Emits an instruction whose memory operand is a stack value.
+ * @j: The JIT state.
+ * @op: The opcode bytes (after the REX prefix).
+ * @n: Number of opcode bytes.
+ * @reg: Register (or opcode extension) of the ModRM reg field.
+ * @index: 13 to address the top value, [r12 + r13 * 4], or 0 to address
+ * the value whose index is in rax, [r12 + rax * 4].
+ */
+void jit_mem(jit_t *j, const char *op, size_t n, int reg, int index)
+{
+	char b[2];
+
+	b[0] = (char)(0x41 | ((reg & 8) ? 4 : 0) | ((index & 8) ? 2 : 0));
+	jit_emit(j, b, 1);
+	jit_emit(j, op, n);
+	b[0] = (char)(((reg & 7) << 3) | 4);
+	b[1] = (char)((2 << 6) | ((index & 7) << 3) | 4);
+	jit_emit(j, b, 2);
+}
+
+/**
+ * jit_rbx - Emits an instruction addressing a field of the stack_t in rbx.
+ * @j: The JIT state.
+ * @op: The prefix, opcode and ModRM bytes, ModRM using a disp8 off rbx.
+ * @n: Number of bytes in @op.
+ * @offset: Offset of the field in stack_t.
+ */
+void jit_rbx(jit_t *j, const char *op, size_t n, size_t offset)
+{
+	jit_emit(j, op, n);
+	jit_imm(j, offset, 1);
+}
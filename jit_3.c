@@ -0,0 +1,116 @@
+#include "monty.h"
+#include <stddef.h>
+
+void jit_jump(jit_t *j, const char *op, size_t n, int kind, int value,
+	      unsigned int line);
+void jit_need(jit_t *j, size_t depth, int kind, instr_t *in);
+void jit_spill(jit_t *j);
+void jit_reload(jit_t *j);
+void jit_slow(jit_t *j, size_t ip);
+
+/**
+ * jit_jump - Emits a jump or call with a rel32 operand.
+ * @j: The JIT state.
+ * @op: The opcode bytes (e.g. "\xe9" or "\x0f\x84").
+ * @n: Number of opcode bytes.
+ * @kind: JIT_AT when @value is a code offset known now, otherwise the
+ * jit_fix_t kind used to patch the operand in jit_finish.
+ * @value: The code offset, or the jit_fix_t value.
+ * @line: The jit_fix_t line.
+ */
+void jit_jump(jit_t *j, const char *op, size_t n, int kind, int value,
+	      unsigned int line)
+{
+	jit_fix_t *fix;
+
+	jit_emit(j, op, n);
+	if (kind == JIT_AT)
+	{
+		jit_imm(j, (size_t)value - (j->len + 4), 4);
+		return;
+	}
+	if (j->n_fix == j->fix_cap)
+	{
+		fix = realloc(j->fix, sizeof(jit_fix_t) *
+			      (j->fix_cap ? j->fix_cap * 2 : 64));
+		if (fix == NULL)
+		{
+			j->failed = 1;
+			return;
+		}
+		j->fix = fix;
+		j->fix_cap = j->fix_cap ? j->fix_cap * 2 : 64;
+	}
+	j->fix[j->n_fix].pos = j->len;
+	j->fix[j->n_fix].kind = kind;
+	j->fix[j->n_fix].value = value;
+	j->fix[j->n_fix].line = line;
+	j->n_fix++;
+	jit_imm(j, 0, 4);
+}
+
+/**
+ * jit_need - Emits the check that the stack holds at least depth values.
+ * @j: The JIT state.
+ * @depth: 1 or 2.
+ * @kind: The error stub to branch to when the check fails.
+ * @in: The instruction being compiled.
+ */
+void jit_need(jit_t *j, size_t depth, int kind, instr_t *in)
+{
+	if (depth == 1)
+	{
+		JIT_EMIT(j, "\x4d\x85\xf6");
+		jit_jump(j, "\x0f\x84", 2, kind, in->op, in->line);
+		return;
+	}
+	JIT_EMIT(j, "\x49\x83\xfe");
+	jit_imm(j, depth, 1);
+	jit_jump(j, "\x0f\x82", 2, kind, in->op, in->line);
+}
+
+/**
+ * jit_spill - Emits the stores of head (r13) and length (r14) to the
+ * stack_t, before C code that reads the stack is called.
+ * @j: The JIT state.
+ */
+void jit_spill(jit_t *j)
+{
+	jit_rbx(j, "\x4c\x89\x6b", 3, offsetof(stack_t, head));
+	jit_rbx(j, "\x4c\x89\x73", 3, offsetof(stack_t, len));
+}
+
+/**
+ * jit_reload - Emits the loads of the stack_t registers, after C code that
+ * may have changed the stack is called.
+ * @j: The JIT state.
+ */
+void jit_reload(jit_t *j)
+{
+	JIT_EMIT(j, "\x48\x8b\x5d\x00");
+	jit_rbx(j, "\x4c\x8b\x63", 3, offsetof(stack_t, vals));
+	jit_rbx(j, "\x4c\x8b\x6b", 3, offsetof(stack_t, head));
+	jit_rbx(j, "\x4c\x8b\x73", 3, offsetof(stack_t, len));
+	jit_rbx(j, "\x4c\x8b\x7b", 3, offsetof(stack_t, cap));
+	JIT_EMIT(j, "\x49\xff\xcf");
+}
+
+/**
+ * jit_slow - Emits a call running one instruction in the interpreter.
+ * @j: The JIT state.
+ * @ip: Index of the instruction.
+ *
+ * If the opcode jumped, execution continues at the native code of its
+ * target through the dispatch table; if it failed, the JIT code returns.
+ */
+void jit_slow(jit_t *j, size_t ip)
+{
+	jit_spill(j);
+	JIT_EMIT(j, "\x48\x89\xef\xbe");
+	jit_imm(j, ip, 4);
+	jit_call(j, (size_t)jit_fallback);
+	jit_reload(j);
+	JIT_EMIT(j, "\x48\x3d");
+	jit_imm(j, ip + 1, 4);
+	jit_jump(j, "\x0f\x85", 2, JIT_AT, j->dispatch, 0);
+}
@@ -0,0 +1,157 @@
+#include "monty.h"
+#include <stddef.h>
+
+void jit_instr(jit_t *j, prog_t *prog, size_t ip);
+void jit_push(jit_t *j, instr_t *in, size_t ip);
+void jit_swap(jit_t *j, instr_t *in);
+void jit_arith(jit_t *j, instr_t *in);
+void jit_print(jit_t *j, instr_t *in);
+
+/**
+ * jit_instr - Emits the native code of one instruction.
+ * @j: The JIT state.
+ * @prog: The program being compiled.
+ * @ip: Index of the instruction.
+ */
+void jit_instr(jit_t *j, prog_t *prog, size_t ip)
+{
+	instr_t *in = &prog->code[ip];
+
+	switch (in->op)
+	{
+	case OP_PUSH:
+		jit_push(j, in, ip);
+		break;
+	case OP_POP:
+		jit_need(j, 1, JIT_FIX_POP, in);
+		JIT_EMIT(j, JIT_DROP);
+		break;
+	case OP_SWAP:
+		jit_swap(j, in);
+		break;
+	case OP_ADD: case OP_SUB: case OP_MUL: case OP_DIV: case OP_MOD:
+		jit_arith(j, in);
+		break;
+	case OP_PINT: case OP_PALL:
+		jit_print(j, in);
+		break;
+	case OP_JMP: case OP_JZ: case OP_JNZ: case OP_LOOP: case OP_DEF:
+		jit_branch(j, in);
+		break;
+	case OP_NOP:
+		break;
+	default:
+		jit_slow(j, ip);
+	}
+}
+
+/**
+ * jit_push - Emits push: an inline store when the stack is in STACK mode
+ * and has room, the interpreter otherwise (always with --max-depth).
+ * @j: The JIT state.
+ * @in: The instruction.
+ * @ip: Index of the instruction.
+ */
+void jit_push(jit_t *j, instr_t *in, size_t ip)
+{
+	size_t slow[2], done;
+
+	if (opts.max_depth)
+	{
+		jit_slow(j, ip);
+		return;
+	}
+	jit_rbx(j, "\x83\x7b", 2, offsetof(stack_t, mode));
+	JIT_EMIT(j, "\x00\x75\x00");
+	slow[0] = j->len;
+	JIT_EMIT(j, "\x4d\x39\xfe\x77\x00");
+	slow[1] = j->len;
+	JIT_EMIT(j, "\x49\xff\xcd\x4d\x21\xfd");
+	jit_mem(j, "\xc7", 1, 0, 13);
+	jit_imm(j, (size_t)in->arg, 4);
+	JIT_EMIT(j, "\x49\xff\xc6\xeb\x00");
+	done = j->len;
+	if (!j->failed)
+	{
+		j->code[slow[0] - 1] = (unsigned char)(done - slow[0]);
+		j->code[slow[1] - 1] = (unsigned char)(done - slow[1]);
+	}
+	jit_slow(j, ip);
+	if (!j->failed)
+		j->code[done - 1] = (unsigned char)(j->len - done);
+}
+
+/**
+ * jit_swap - Emits swap.
+ * @j: The JIT state.
+ * @in: The instruction.
+ */
+void jit_swap(jit_t *j, instr_t *in)
+{
+	jit_need(j, 2, JIT_FIX_SHORT, in);
+	JIT_EMIT(j, "\x49\x8d\x45\x01\x4c\x21\xf8");
+	jit_mem(j, "\x8b", 1, 1, 13);
+	jit_mem(j, "\x8b", 1, 2, 0);
+	jit_mem(j, "\x89", 1, 2, 13);
+	jit_mem(j, "\x89", 1, 1, 0);
+}
+
+/**
+ * jit_arith - Emits add, sub, mul, div or mod.
+ * @j: The JIT state.
+ * @in: The instruction.
+ *
+ * The result replaces the second value, then the top is dropped, as in
+ * the interpreter; div and mod check the divisor first.
+ */
+void jit_arith(jit_t *j, instr_t *in)
+{
+	jit_need(j, 2, JIT_FIX_SHORT, in);
+	if (in->op == OP_DIV || in->op == OP_MOD)
+	{
+		jit_mem(j, "\x8b", 1, 1, 13);
+		JIT_EMIT(j, "\x85\xc9");
+		jit_jump(j, "\x0f\x84", 2, JIT_FIX_DIV, in->op, in->line);
+		JIT_EMIT(j, JIT_DROP);
+		jit_mem(j, "\x8b", 1, 0, 13);
+		JIT_EMIT(j, "\x99\xf7\xf9");
+		jit_mem(j, "\x89", 1, in->op == OP_DIV ? 0 : 2, 13);
+		return;
+	}
+	jit_mem(j, "\x8b", 1, 0, 13);
+	JIT_EMIT(j, JIT_DROP);
+	if (in->op == OP_ADD)
+		jit_mem(j, "\x01", 1, 0, 13);
+	else if (in->op == OP_SUB)
+		jit_mem(j, "\x29", 1, 0, 13);
+	else
+	{
+		jit_mem(j, "\x0f\xaf", 2, 0, 13);
+		jit_mem(j, "\x89", 1, 0, 13);
+	}
+}
+
+/**
+ * jit_print - Emits pint (an inline printf) or pall (a call to monty_pall).
+ * @j: The JIT state.
+ * @in: The instruction.
+ */
+void jit_print(jit_t *j, instr_t *in)
+{
+	static char fmt[] = "%d\n";
+
+	if (in->op == OP_PALL)
+	{
+		jit_spill(j);
+		JIT_EMIT(j, "\x48\x89\xef\xbe");
+		jit_imm(j, in->line, 4);
+		jit_call(j, (size_t)monty_pall);
+		return;
+	}
+	jit_need(j, 1, JIT_FIX_PINT, in);
+	jit_mem(j, "\x8b", 1, 6, 13);
+	JIT_EMIT(j, "\x48\xbf");
+	jit_imm(j, (size_t)fmt, 8);
+	JIT_EMIT(j, "\x31\xc0");
+	jit_call(j, (size_t)printf);
+}
@@ -0,0 +1,84 @@
+#include "monty.h"
+
+void jit_branch(jit_t *j, instr_t *in);
+void jit_call(jit_t *j, size_t fn);
+void jit_prologue(jit_t *j);
+
+/**
+ * jit_branch - Emits jmp, jz, jnz, loop or def as native jumps.
+ * @j: The JIT state.
+ * @in: The instruction; its operand is the target instruction index.
+ */
+void jit_branch(jit_t *j, instr_t *in)
+{
+	if (in->op == OP_JMP || in->op == OP_DEF)
+	{
+		jit_jump(j, "\xe9", 1, JIT_FIX_IP, in->arg, in->line);
+		return;
+	}
+	jit_need(j, 1, JIT_FIX_EMPTY, in);
+	if (in->op == OP_LOOP)
+	{
+		jit_mem(j, "\xff", 1, 1, 13);
+		jit_jump(j, "\x0f\x8f", 2, JIT_FIX_IP, in->arg, in->line);
+		JIT_EMIT(j, JIT_DROP);
+		return;
+	}
+	jit_mem(j, "\x83", 1, 7, 13);
+	JIT_EMIT(j, "\x00");
+	jit_jump(j, in->op == OP_JZ ? "\x0f\x84" : "\x0f\x85", 2, JIT_FIX_IP,
+		 in->arg, in->line);
+}
+
+/**
+ * jit_call - Emits a call to a C function through r11.
+ * @j: The JIT state.
+ * @fn: Address of the function.
+ *
+ * rax is left alone so that variadic calls can set al beforehand.
+ */
+void jit_call(jit_t *j, size_t fn)
+{
+	JIT_EMIT(j, "\x49\xbb");
+	jit_imm(j, fn, 8);
+	JIT_EMIT(j, "\x41\xff\xd3");
+}
+
+/**
+ * jit_prologue - Emits the entry of the JIT function and its shared exits.
+ * @j: The JIT state, with an empty buffer.
+ *
+ * Description: The function is int fn(stack_t **stack). It saves the
+ * callee-saved registers, keeps stack in rbp, then jumps over the shared
+ * epilogue, the failure exit and the dispatch routine to the code that
+ * loads the stack_t registers.
+ */
+void jit_prologue(jit_t *j)
+{
+	size_t start;
+
+	JIT_EMIT(j, "\x55\x53\x41\x54\x41\x55\x41\x56\x41\x57");
+	JIT_EMIT(j, "\x48\x83\xec\x08\x48\x89\xfd\xe9\x00\x00\x00\x00");
+	start = j->len;
+
+	j->epilogue = j->len;
+	jit_spill(j);
+	JIT_EMIT(j, "\x48\x83\xc4\x08\x41\x5f\x41\x5e");
+	JIT_EMIT(j, "\x41\x5d\x41\x5c\x5b\x5d\xc3");
+
+	j->fail = j->len;
+	JIT_EMIT(j, "\x48\xb8");
+	jit_imm(j, (size_t)&vm.status, 8);
+	JIT_EMIT(j, "\x8b\x00");
+	jit_jump(j, "\xe9", 1, JIT_AT, j->epilogue, 0);
+
+	j->dispatch = j->len;
+	JIT_EMIT(j, "\x48\x85\xc0");
+	jit_jump(j, "\x0f\x88", 2, JIT_AT, j->fail, 0);
+	JIT_EMIT(j, "\x48\xb9");
+	jit_imm(j, (size_t)j->table, 8);
+	JIT_EMIT(j, "\xff\x24\xc1");
+
+	jit_imm_at(j, start - 4, j->len - start);
+	jit_reload(j);
+}
@@ -0,0 +1,151 @@
+#include "monty.h"
+#include <string.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define LEX_WIDTH 32
+#define LEX_VEC __m256i
+#define LEX_LOAD(p) _mm256_load_si256((const __m256i *)(p))
+#define LEX_ZERO() _mm256_setzero_si256()
+#define LEX_EQ(v, c) _mm256_cmpeq_epi8((v), _mm256_set1_epi8(c))
+#define LEX_OR(a, b) _mm256_or_si256((a), (b))
+#define LEX_MASK(v) ((uint64_t)(uint32_t)_mm256_movemask_epi8(v))
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define LEX_WIDTH 16
+#define LEX_VEC __m128i
+#define LEX_LOAD(p) _mm_load_si128((const __m128i *)(p))
+#define LEX_ZERO() _mm_setzero_si128()
+#define LEX_EQ(v, c) _mm_cmpeq_epi8((v), _mm_set1_epi8(c))
+#define LEX_OR(a, b) _mm_or_si128((a), (b))
+#define LEX_MASK(v) ((uint64_t)(uint16_t)_mm_movemask_epi8(v))
+#endif
+
+void lex_init(lex_set_t *set, const char *delims);
+uint64_t lex_block(const char *p, size_t skip, const lex_set_t *set,
+		   uint64_t *nul);
+size_t lex_scan(const char *str, const lex_set_t *set, lex_span_t *spans,
+		size_t max);
+
+/**
+ * lex_init - Prepares a delimiter set for lex_scan.
+ * @set: The lex_set_t to fill in.
+ * @delims: The delimiter characters.
+ */
+void lex_init(lex_set_t *set, const char *delims)
+{
+	unsigned char c;
+
+	memset(set, 0, sizeof(*set));
+	for (; *delims; delims++)
+	{
+		c = *delims;
+		set->bits[c >> 6] |= (uint64_t)1 << (c & 63);
+		if (set->n < LEX_DELIMS)
+			set->c[set->n] = c;
+		set->n++;
+	}
+}
+
+/**
+ * lex_block - Classifies the 64 bytes of an aligned block.
+ * @p: The block, 64-byte aligned.
+ * @skip: Number of leading bytes that are not part of the string.
+ * @set: The delimiters.
+ * @nul: Where to store the mask of NUL bytes.
+ *
+ * Description: Bit i of the masks stands for p[i]. The SIMD lexer reads
+ * the whole block, which can't cross a page, so it may look past the
+ * string's NUL; the scalar one stops there. Bits after the first NUL are
+ * meaningless, and the @skip bytes before the string count as delimiters.
+ *
+ * Return: The mask of delimiters.
+ */
+#if defined(LEX_WIDTH) && defined(__SANITIZE_ADDRESS__)
+__attribute__((no_sanitize_address))
+#endif
+uint64_t lex_block(const char *p, size_t skip, const lex_set_t *set,
+		   uint64_t *nul)
+{
+	uint64_t delim = 0, zero = 0, before = ((uint64_t)1 << skip) - 1;
+	size_t i;
+	unsigned char c;
+
+#ifdef LEX_WIDTH
+	if (set->n <= LEX_DELIMS)
+	{
+		LEX_VEC v, hit;
+		int j;
+
+		for (i = 0; i < 64; i += LEX_WIDTH)
+		{
+			v = LEX_LOAD(p + i);
+			hit = LEX_ZERO();
+			for (j = 0; j < set->n; j++)
+				hit = LEX_OR(hit, LEX_EQ(v, set->c[j]));
+			delim |= LEX_MASK(hit) << i;
+			zero |= LEX_MASK(LEX_EQ(v, 0)) << i;
+		}
+		*nul = zero & ~before;
+		return (delim | before);
+	}
+#endif
+	for (i = skip; i < 64; i++)
+	{
+		c = p[i];
+		if (c == '\0')
+		{
+			zero |= (uint64_t)1 << i;
+			break;
+		}
+		delim |= (set->bits[c >> 6] >> (c & 63) & 1) << i;
+	}
+	*nul = zero;
+	return (delim | before);
+}
+
+/**
+ * lex_scan - Finds the words of a string, 64 bytes at a time.
+ * @str: The string.
+ * @set: The delimiters, from lex_init.
+ * @spans: Where to store the first @max words, or NULL if @max is 0.
+ * @max: Size of @spans.
+ *
+ * Description: With the masks of lex_block, a word starts or ends wherever
+ * a byte and the one before it are not both in words, so each block needs
+ * one XOR and a loop over the set bits instead of a pass per delimiter.
+ *
+ * Return: The number of words, which may be more than @max.
+ */
+size_t lex_scan(const char *str, const lex_set_t *set, lex_span_t *spans,
+		size_t max)
+{
+	const char *p = (const char *)((uintptr_t)str & ~(uintptr_t)63);
+	size_t skip = str - p, base = 0, count = 0, start = 0, pos;
+	uint64_t word, nul, edges, in = 0;
+	int open = 0;
+
+	for (;; p += 64, base += 64)
+	{
+		word = ~lex_block(p, base ? 0 : skip, set, &nul);
+		if (nul)
+			word &= (nul & (~nul + 1)) - 1;
+		edges = word ^ (word << 1 | in);
+		in = word >> 63;
+		for (; edges; edges &= edges - 1)
+		{
+			pos = base + __builtin_ctzll(edges) - skip;
+			if (!open)
+				start = pos;
+			else if (count < max)
+			{
+				spans[count].off = start;
+				spans[count].len = pos - start;
+			}
+			count += open;
+			open = !open;
+		}
+		if (nul)
+			return (count);
+	}
+}
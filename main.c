@@ -1,15 +1,158 @@
 #include "monty.h"
+#include <string.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
+#include <errno.h>
 
-char **op_toks = NULL;
+__thread char **op_toks = NULL;
+opts_t opts;
+
+int parse_args(int argc, char **argv, char **file);
+unsigned long parse_num(char *s, int *bad);
+
+/**
+ * parse_num - Reads the number a flag takes.
+ * @s: The argument after the flag, or NULL if there is none.
+ * @bad: Set to 1 if @s is not a whole decimal number that fits.
+ *
+ * Return: The number, or 0 if it is bad.
+ */
+unsigned long parse_num(char *s, int *bad)
+{
+	unsigned long n = 0;
+	char *end = NULL;
+
+	errno = 0;
+	if (s != NULL && *s >= '0' && *s <= '9')
+		n = strtoul(s, &end, 10);
+	if (end == NULL || *end != '\0' || errno == ERANGE)
+	{
+		*bad = 1;
+		return (0);
+	}
+	return (n);
+}
+
+/**
+ * parse_args - Reads the command-line flags into opts.
+ * @argc: Number of command-line arguments.
+ * @argv: Array of command-line argument strings.
+ * @file: Set to the script path, or NULL when --serve needs none.
+ *
+ * Flags come first and the script, when there is one, last; --serve
+ * takes none, so flags may follow its socket.
+ *
+ * --trace, --checkpoint-every/--resume, --incremental and --spill each
+ * run the script their own way, so at most one of them may be given, and
+ * none with the daemon. Numbers must be plain decimal.
+ *
+ * Return: EXIT_SUCCESS, or EXIT_FAILURE on a usage error.
+ */
+int parse_args(int argc, char **argv, char **file)
+{
+	int i, bad = 0;
+
+	opts.timeout = SERVE_TIMEOUT;
+	for (i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--bf") == 0)
+			opts.bf = 1;
+		else if (strcmp(argv[i], "--bf-naive") == 0)
+			opts.bf = 2;
+		else if (strcmp(argv[i], "--jit") == 0)
+			opts.jit = 1;
+		else if (strcmp(argv[i], "--emit-c") == 0)
+			opts.emit_c = 1;
+		else if (strcmp(argv[i], "--cache") == 0)
+			opts.cache = 1;
+		else if (strcmp(argv[i], "--checkpoint-every") == 0)
+		{
+			opts.ckpt_every = parse_num(argv[++i], &bad);
+			if (opts.ckpt_every == 0)
+				return (EXIT_FAILURE);
+		}
+		else if (strcmp(argv[i], "--resume") == 0)
+			opts.resume = argv[++i];
+		else if (strcmp(argv[i], "--trace") == 0)
+			opts.trace = argv[++i];
+		else if (strcmp(argv[i], "--trace-decode") == 0)
+			opts.trace_decode = 1;
+		else if (strcmp(argv[i], "--incremental") == 0)
+			opts.incremental = 1;
+		else if (strcmp(argv[i], "--max-depth") == 0)
+			opts.max_depth = parse_num(argv[++i], &bad);
+		else if (strcmp(argv[i], "--max-memory") == 0)
+			opts.max_memory = parse_num(argv[++i], &bad);
+		else if (strcmp(argv[i], "--spill") == 0)
+			opts.spill = 1;
+		else if (strcmp(argv[i], "--serve") == 0)
+			opts.serve = argv[++i];
+		else if (strcmp(argv[i], "--submit") == 0)
+			opts.submit = argv[++i];
+		else if (strcmp(argv[i], "--green") == 0)
+			opts.green = 1;
+		else if (strcmp(argv[i], "--timeout") == 0)
+			opts.timeout = parse_num(argv[++i], &bad);
+		else if (strcmp(argv[i], "--no-dce") == 0)
+			opts.no_dce = 1;
+		else
+			break;
+	}
+	if (bad)
+		return (EXIT_FAILURE);
+	if ((opts.trace != NULL) + (opts.ckpt_every || opts.resume) +
+	    opts.incremental + opts.spill > 1)
+		return (EXIT_FAILURE);
+	if ((opts.trace || opts.ckpt_every || opts.resume || opts.incremental ||
+	     opts.spill) && (opts.serve || opts.submit))
+		return (EXIT_FAILURE);
+	if (opts.green && opts.serve == NULL)
+		return (EXIT_FAILURE);
+	if (opts.spill && opts.max_memory == 0)
+		opts.max_memory = SPILL_MEMORY;
+	if (opts.spill && opts.max_memory < SPILL_MIN_MEMORY)
+		return (EXIT_FAILURE);
+	*file = NULL;
+	if (opts.serve != NULL && i == argc && opts.submit == NULL)
+		return (EXIT_SUCCESS);
+	if (opts.serve != NULL || argc - i != 1)
+		return (EXIT_FAILURE);
+	*file = argv[i];
+	opts.script = argv[i];
+	return (EXIT_SUCCESS);
+}
 
 /**
  * main - Monty Interpreter Entry Point
  * @argc: Number of command-line arguments.
  * @argv: Array of command-line argument strings.
  *
+ * Description: "monty file" runs a Monty script; "monty --bf file" runs a
+ * Brainfuck program on the same VM ("--bf-naive" skips the peephole
+ * optimizations, as a baseline). "--jit" runs programs as native code and
+ * "--emit-c" prints them as a C program instead of running them.
+ * "--cache" keeps decoded scripts in the disk cache. "--no-dce" runs
+ * trailing instructions whose results are never printed.
+ * "--checkpoint-every N" snapshots the VM to "file.ckpt" every N
+ * instructions and "--resume snapshot" continues a run from one, given the
+ * same stdin; once read has used a stdin that cannot seek (a pipe), no
+ * more snapshots are taken.
+ * "--trace out.bin" records every executed instruction and
+ * "monty --trace-decode out.bin" prints such a trace as text.
+ * "--incremental" lets a rerun of an edited script skip its unchanged
+ * beginning.
+ * "--max-depth N" caps every stack at N values and "--max-memory BYTES"
+ * caps the memory of all stacks together; with "--spill", stacks past
+ * that memory page their bottom out to a temporary file instead, which
+ * takes a --max-memory of at least 263168 (SPILL_MIN_MEMORY) for each
+ * stack that spills.
+ * "monty --serve sock" runs a daemon on a Unix socket and
+ * "monty --submit sock file" runs a script on it, in the submitter's
+ * working directory; with "--green" each worker of the daemon interleaves
+ * thousands of scripts. "--timeout SECONDS" stops daemon jobs that run
+ * longer (300 by default, 0 for no limit).
+ *
  * Return: EXIT_SUCCESS if the program executes successfully,
  * EXIT_FAILURE on
  * error.
@@ -18,13 +161,23 @@ int main(int argc, char **argv)
 {
 	FILE *script_fd = NULL;
 	int exit_code = EXIT_SUCCESS;
+	char *file;
 
-	if (argc != 2)
+	if (parse_args(argc, argv, &file) == EXIT_FAILURE)
 		return (usage_error());
-	script_fd = fopen(argv[1], "r");
+	if (opts.serve != NULL)
+		return (monty_serve(opts.serve));
+	if (opts.submit != NULL)
+		return (monty_submit(opts.submit, file));
+	script_fd = fopen(file, "r");
 	if (script_fd == NULL)
-		return (f_open_error(argv[1]));
-	exit_code = run_monty(script_fd);
+		return (f_open_error(file));
+	if (opts.trace_decode)
+		exit_code = trace_decode(script_fd);
+	else if (opts.bf)
+		exit_code = run_bf(script_fd, opts.bf == 1);
+	else
+		exit_code = run_monty(script_fd);
 	fclose(script_fd);
 	return (exit_code);
 }
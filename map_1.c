@@ -0,0 +1,94 @@
+#include "monty.h"
+
+int map_put(map_t **map, int key, int val);
+int *map_get(map_t *map, int key);
+size_t map_slot(map_t *map, int key);
+
+/**
+ * map_put - Sets the value of a key, creating the map if needed.
+ * @map: Pointer to the map, or to NULL.
+ * @key: The key.
+ * @val: The value.
+ *
+ * The table doubles once it is three quarters full; its slots are the
+ * only allocation, so storing a key never mallocs on its own.
+ *
+ * Return: EXIT_SUCCESS, EXIT_FAILURE if malloc fails, or STACK_LIMIT if
+ * the table would outgrow --max-memory.
+ */
+int map_put(map_t **map, int key, int val)
+{
+	map_t *m = *map;
+	size_t i;
+	int status;
+
+	if (m == NULL)
+	{
+		m = calloc(1, sizeof(*m));
+		if (m == NULL)
+			return (EXIT_FAILURE);
+		*map = m;
+	}
+	if (key == MAP_EMPTY)
+	{
+		m->has_empty = 1;
+		m->empty_val = val;
+		return (EXIT_SUCCESS);
+	}
+	if (4 * (m->len + 1) > 3 * m->cap)
+	{
+		status = map_grow(m);
+		if (status != EXIT_SUCCESS)
+			return (status);
+	}
+	i = MAP_HASH(key, m->cap);
+	while (m->slots[i].key != MAP_EMPTY && m->slots[i].key != key)
+		i = (i + 1) & (m->cap - 1);
+	if (m->slots[i].key == MAP_EMPTY)
+		m->len++;
+	m->slots[i].key = key;
+	m->slots[i].val = val;
+	return (EXIT_SUCCESS);
+}
+
+/**
+ * map_get - Finds the value of a key.
+ * @map: The map, or NULL.
+ * @key: The key.
+ *
+ * Return: A pointer to the value, or NULL if the key is not in the map.
+ */
+int *map_get(map_t *map, int key)
+{
+	size_t i;
+
+	if (map == NULL)
+		return (NULL);
+	if (key == MAP_EMPTY)
+		return (map->has_empty ? &map->empty_val : NULL);
+	i = map_slot(map, key);
+	return (i < map->cap ? &map->slots[i].val : NULL);
+}
+
+/**
+ * map_slot - Finds the slot of a key other than MAP_EMPTY.
+ * @map: The map.
+ * @key: The key.
+ *
+ * Return: Index of the slot, or @map->cap if the key is not in the map.
+ */
+size_t map_slot(map_t *map, int key)
+{
+	size_t i;
+
+	if (map->len == 0)
+		return (map->cap);
+	i = MAP_HASH(key, map->cap);
+	while (map->slots[i].key != key)
+	{
+		if (map->slots[i].key == MAP_EMPTY)
+			return (map->cap);
+		i = (i + 1) & (map->cap - 1);
+	}
+	return (i);
+}
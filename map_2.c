@@ -0,0 +1,96 @@
+#include "monty.h"
+
+int map_del(map_t *map, int key);
+int map_grow(map_t *map);
+void map_free(map_t **map);
+
+/**
+ * map_del - Removes a key.
+ * @map: The map, or NULL.
+ * @key: The key.
+ *
+ * The slots after it in its probe run move back into the gap when their
+ * home slot allows, so lookups never need to skip deleted slots.
+ *
+ * Return: 1 if the key was in the map, else 0.
+ */
+int map_del(map_t *map, int key)
+{
+	size_t i, j, home, mask;
+
+	if (map == NULL)
+		return (0);
+	if (key == MAP_EMPTY)
+	{
+		i = map->has_empty;
+		map->has_empty = 0;
+		return (i);
+	}
+	i = map_slot(map, key);
+	if (i == map->cap)
+		return (0);
+	mask = map->cap - 1;
+	for (j = (i + 1) & mask; map->slots[j].key != MAP_EMPTY;
+	     j = (j + 1) & mask)
+	{
+		home = MAP_HASH(map->slots[j].key, map->cap);
+		if (((j - home) & mask) >= ((j - i) & mask))
+		{
+			map->slots[i] = map->slots[j];
+			i = j;
+		}
+	}
+	map->slots[i].key = MAP_EMPTY;
+	map->len--;
+	return (1);
+}
+
+/**
+ * map_grow - Doubles the slots of a map, or allocates its first ones.
+ * @map: The map.
+ *
+ * Return: EXIT_SUCCESS, EXIT_FAILURE if malloc fails, or STACK_LIMIT if
+ * the table would outgrow --max-memory.
+ */
+int map_grow(map_t *map)
+{
+	size_t cap = map->cap ? map->cap * 2 : MAP_INIT_CAP, i, j;
+	map_slot_t *slots;
+
+	if (opts.max_memory &&
+	    vm.mem + sizeof(map_slot_t) * (cap - map->cap) > opts.max_memory)
+		return (STACK_LIMIT);
+	slots = malloc(sizeof(map_slot_t) * cap);
+	if (slots == NULL)
+		return (EXIT_FAILURE);
+	for (i = 0; i < cap; i++)
+		slots[i].key = MAP_EMPTY;
+	for (i = 0; i < map->cap; i++)
+	{
+		if (map->slots[i].key == MAP_EMPTY)
+			continue;
+		j = MAP_HASH(map->slots[i].key, cap);
+		while (slots[j].key != MAP_EMPTY)
+			j = (j + 1) & (cap - 1);
+		slots[j] = map->slots[i];
+	}
+	free(map->slots);
+	vm.mem += sizeof(map_slot_t) * (cap - map->cap);
+	map->slots = slots;
+	map->cap = cap;
+	return (EXIT_SUCCESS);
+}
+
+/**
+ * map_free - Releases a map and resets the caller's pointer to NULL.
+ * @map: Pointer to the map, or to NULL.
+ */
+void map_free(map_t **map)
+{
+	if (*map == NULL)
+		return;
+	vm.mem -= sizeof(map_slot_t) * (*map)->cap;
+	free((*map)->slots);
+	free(*map);
+	*map = NULL;
+}
@@ -3,36 +3,170 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <unistd.h>
+#include <sys/un.h>
+#include <pthread.h>
 
 #define STACK 0
 #define QUEUE 1
+#define STACK_INIT_CAP 16
+/* STACK_BANK - Number of stacks select, movto and movfrom can address */
+#define STACK_BANK 16
+#define STACK_BANK_RANGE "0-15"
+/* STACK_LIMIT, STACK_IO - Failures of stack_push besides EXIT_FAILURE */
+#define STACK_LIMIT 2
+#define STACK_IO 3
+/* VM_WAIT - vm.status of a --green VM that yields until stdin is ready */
+#define VM_WAIT 4
+/* INPUT_WAIT - input_int and input_fill: stdin has nothing to read yet */
+#define INPUT_WAIT (-2)
+/* SPILL_CHUNK - Values per chunk of a spill file */
+#define SPILL_CHUNK 16384
+/* SPILL_KEEP - Values a spilled stack keeps in its ring buffer */
+#define SPILL_KEEP 16
+/* SPILL_SHARE - Spilling ring buffers stay under 1/SPILL_SHARE of the limit */
+#define SPILL_SHARE 8
+/* SPILL_MEMORY - Default --max-memory with --spill */
+#define SPILL_MEMORY (1UL << 28)
+/*
+ * SPILL_MIN_MEMORY - Smallest --max-memory with --spill: the bank, then a
+ * ring buffer of 2 * SPILL_CHUNK values, the least spill_out pages out
+ * of, and the two chunk buffers of its spill
+ */
+#define SPILL_MIN_MEMORY \
+	(sizeof(int) * (STACK_BANK * STACK_INIT_CAP + 4 * SPILL_CHUNK))
+/* RET_DEPTH - Size of the return stack of call and ret */
+#define RET_DEPTH 4096
+/* INPUT_BUF - Bytes read and READ_BATCH - values pushed at a time by readall */
+#define INPUT_BUF (1 << 16)
+#define READ_BATCH 1024
 #define DELIMS " \n\t\a\b"
+#define BF_TAPE 32768
+/* MAP_INIT_CAP - Slots of a map when the first key is stored */
+#define MAP_INIT_CAP 16
+/* MAP_EMPTY - Key of an unused map slot; the key itself is kept apart */
+#define MAP_EMPTY INT32_MIN
+/* MAP_HASH - The home slot of @key in a table of @cap slots */
+#define MAP_HASH(key, cap) \
+	((((uint32_t)(key) * 0x9e3779b1U) ^ ((uint32_t)(key) >> 16)) & \
+	 ((cap) - 1))
+
+/* op_toks - Tokens of the line being decoded, per thread (see parse_1.c) */
+extern __thread char **op_toks;
+
+/**
+ * struct spill_chunk_s - A chunk of a spill file
+ * @slot: Position of the chunk in the file, in SPILL_CHUNK units
+ * @len: Number of values in the chunk, top first
+ */
+typedef struct spill_chunk_s
+{
+	size_t slot;
+	size_t len;
+} spill_chunk_t;
 
-extern char **op_toks;
+/**
+ * struct spill_s - The cold bottom of a stack_t paged out with --spill
+ * @file: Temporary file holding the chunks
+ * @len: Number of values held here instead of in the ring buffer
+ * @chunks: The chunks below the ring buffer, top first
+ * @n_chunks: Number of chunks
+ * @chunks_cap: Allocated size of @chunks
+ * @free: Slots of the file that chunks were read back from
+ * @n_free: Number of free slots
+ * @n_slots: Number of slots in the file
+ * @tail: The bottommost values, below all chunks, top first; queue pushes
+ * and rotl land here
+ * @tail_len: Number of values in @tail
+ * @buf: SPILL_CHUNK values of scratch space
+ */
+typedef struct spill_s
+{
+	FILE *file;
+	size_t len;
+	spill_chunk_t *chunks;
+	size_t n_chunks;
+	size_t chunks_cap;
+	size_t *free;
+	size_t n_free;
+	size_t n_slots;
+	int *tail;
+	size_t tail_len;
+	int *buf;
+} spill_t;
 
 /**
- * struct stack_s - A versatile, bi-directional list node for stack and queue.
+ * struct map_slot_s - A slot of a map
+ * @key: The key, or MAP_EMPTY
+ * @val: Its value
+ */
+typedef struct map_slot_s
+{
+	int key;
+	int val;
+} map_slot_t;
+
+/**
+ * struct map_s - The int-to-int map of store, fetch, has and del
+ * @slots: Open-addressed table of @cap slots, probed linearly; deletion
+ * shifts the following slots back, so there are no tombstones
+ * @cap: Number of slots, always a power of two
+ * @len: Number of slots in use
+ * @has_empty: Set when MAP_EMPTY itself is a key
+ * @empty_val: The value of MAP_EMPTY
+ */
+typedef struct map_s
+{
+	map_slot_t *slots;
+	size_t cap;
+	size_t len;
+	int has_empty;
+	int empty_val;
+} map_t;
+
+/**
+ * struct stack_s - A double-ended queue backing both stack and queue modes.
  *
- * @n: An integer value contained in the node.
- * @prev: A link to the previous element in the stack/queue.
- * @next: A link to the next element in the stack/queue.
+ * @vals: Ring buffer of values, @cap slots long.
+ * @head: Index in @vals of the top (stack) or front (queue) element.
+ * @len: Number of values currently held.
+ * @cap: Number of slots in @vals, always a power of two.
+ * @mode: STACK or QUEUE, selects the end monty_push grows.
+ * @id: Index of the stack_t in its bank (see init_stack).
+ * @spill: Values paged out below the ring buffer with --spill, or NULL.
+ * @map: The map of the program, in the first stack_t of the bank only;
+ * NULL until a key is stored.
  *
- * Description: A powerful node structure for creating stack, queue, LIFO,
- * and FIFO data structures, designed for the Holberton project.
+ * Description: The top element lives at vals[head] and the bottom one at
+ * vals[(head + len - 1) & (cap - 1)], so rotations and mode switches only
+ * move indices instead of walking a linked list.
  */
-
 typedef struct stack_s
 {
-	int n;
-	struct stack_s *prev;
-	struct stack_s *next;
+	int *vals;
+	size_t head;
+	size_t len;
+	size_t cap;
+	int mode;
+	int id;
+	spill_t *spill;
+	map_t *map;
 } stack_t;
 
+/* STACK_AT - The value @i places below the top of @s */
+#define STACK_AT(s, i) ((s)->vals[((s)->head + (i)) & ((s)->cap - 1)])
+/* STACK_DEPTH - Number of values on @s, including spilled ones */
+#define STACK_DEPTH(s) ((s)->len + ((s)->spill ? (s)->spill->len : 0))
+/* STACK_MAP - The map slot of the bank @s belongs to */
+#define STACK_MAP(s) (&((s) - (s)->id)->map)
+
 /**
  * struct instruction_s - Encapsulates an opcode and its associated function
  * @opcode: A unique identifier for the operation
  * @f: A function pointer for handling the opcode
+ * @operand: Kind of operand the opcode takes (OPND_NONE, OPND_INT,
+ * OPND_LABEL, OPND_STACK, OPND_STRING, OPND_LIST, OPND_INDEX or OPND_PATH)
  *
  * Summary: This structure associates an opcode with its designated
  * function for use in Holberton's stack, queue, LIFO, and FIFO project.
@@ -41,15 +175,856 @@ typedef struct instruction_s
 {
 	char *opcode;
 	void (*f)(stack_t **stack, unsigned int line_number);
+	int operand;
 } instruction_t;
 
+#define OPND_NONE 0
+#define OPND_INT 1
+#define OPND_LABEL 2
+#define OPND_STACK 3
+#define OPND_STRING 4
+#define OPND_LIST 5
+#define OPND_INDEX 6
+#define OPND_PATH 7
+
+/* OPND_USAGE - What the usage error of a bad operand of opcode @op asks for */
+#define OPND_USAGE(op) \
+	(op_table[op].operand == OPND_STACK ? STACK_BANK_RANGE : \
+	 op_table[op].operand == OPND_STRING ? "\"text\"" : \
+	 op_table[op].operand == OPND_LIST ? "integer ..." : \
+	 op_table[op].operand == OPND_INDEX ? "integer >= 0" : \
+	 op_table[op].operand == OPND_PATH ? "file" : "integer")
+
+/*
+ * Opcode indices into op_table. The order must match the table in
+ * monty_run.c; the entries from OP_BAD_OP on are internal and are never
+ * matched against script text.
+ */
+enum op_id
+{
+	OP_PUSH, OP_PALL, OP_PINT, OP_POP, OP_SWAP, OP_ADD, OP_NOP, OP_SUB,
+	OP_DIV, OP_MUL, OP_MOD, OP_PCHAR, OP_PSTR, OP_ROTL, OP_ROTR, OP_STACK,
+	OP_QUEUE, OP_ROTN, OP_JMP, OP_JZ, OP_JNZ, OP_LOOP, OP_SELECT, OP_MOVTO,
+	OP_MOVFROM, OP_DEF, OP_END, OP_CALL, OP_RET, OP_PUSHS, OP_PUSHN,
+	OP_DUP, OP_OVER, OP_PICK, OP_ROLL, OP_DROP, OP_READ, OP_READALL,
+	OP_LOAD, OP_SAVE, OP_STORE, OP_FETCH, OP_HAS, OP_DEL,
+	OP_BAD_OP, OP_BAD_ARG,
+	OP_BF_ADD, OP_BF_OUT, OP_BF_IN, OP_BF_CLEAR, OP_BF_MUL,
+	OP_COUNT
+};
+
+/**
+ * struct instr_s - A decoded Monty instruction
+ * @op: Index of the opcode in op_table (an OP_* value)
+ * @arg: Integer operand: the value to push, a rotation count, a depth
+ * below the top, a jump
+ * target instruction index, an index into the program's names (unknown
+ * opcodes and load/save files), or the
+ * offset of a pushs/pushn literal in the program's pool
+ * @line: Line number in the Monty bytecode file, for error messages
+ */
+typedef struct instr_s
+{
+	int op;
+	int arg;
+	unsigned int line;
+} instr_t;
+
+/**
+ * struct label_s - A label definition found while loading a program
+ * @name: The label name
+ * @target: Index of the instruction following the definition
+ * @line: Line number of the definition
+ */
+typedef struct label_s
+{
+	char *name;
+	int target;
+	unsigned int line;
+} label_t;
+
+/**
+ * struct prog_s - A Monty script decoded into a compact instruction array
+ * @code: The instructions, in source order
+ * @len: Number of instructions in @code
+ * @cap: Allocated size of @code
+ * @names: Strings referenced by instruction operands (unknown opcodes,
+ * jump label names until they are resolved)
+ * @n_names: Number of entries in @names
+ * @names_cap: Allocated size of @names
+ * @labels: Label definitions, sorted by name once loading is done
+ * @n_labels: Number of entries in @labels
+ * @labels_cap: Allocated size of @labels
+ * @pool: Literals of pushs and pushn: at each instruction's offset, the
+ * count of values, then the values in the order they end up on a stack,
+ * top first
+ * @pool_len: Number of ints in @pool
+ * @pool_cap: Allocated size of @pool
+ * @nul_tail: Set when the last line read starts with a NUL byte, which
+ * run_monty has always reported as a malloc failure
+ * @map: Mapping of the cache entry @code, @pool and @names point into,
+ * or NULL
+ * @map_len: Length of @map
+ */
+typedef struct prog_s
+{
+	instr_t *code;
+	size_t len;
+	size_t cap;
+	char **names;
+	size_t n_names;
+	size_t names_cap;
+	label_t *labels;
+	size_t n_labels;
+	size_t labels_cap;
+	int *pool;
+	size_t pool_len;
+	size_t pool_cap;
+	int nul_tail;
+	void *map;
+	size_t map_len;
+} prog_t;
+
+/* PARSE_MIN - Scripts smaller than this are decoded by a single thread */
+#define PARSE_MIN (1 << 20)
+#define PARSE_THREADS 64
+/* PARSE_RETRY - A chunk hit a load error; decode sequentially to report it */
+#define PARSE_RETRY 2
+
+/**
+ * struct parse_chunk_s - A slice of a script decoded by one thread
+ * @src: First byte of the slice, at the start of a line
+ * @len: Length of the slice, which ends after a newline unless it is the
+ * last one
+ * @prog: The slice decoded on its own: line numbers count from 1, names
+ * and labels index the slice's own arrays
+ * @lines: Number of lines in the slice
+ * @status: EXIT_SUCCESS, EXIT_FAILURE or PARSE_RETRY
+ */
+typedef struct parse_chunk_s
+{
+	const char *src;
+	size_t len;
+	prog_t prog;
+	size_t lines;
+	int status;
+} parse_chunk_t;
+
+/* DCE_KNOWN - Top values the dead-code pass follows as constants */
+#define DCE_KNOWN 4
+
+/**
+ * struct dce_s - What the dead-code pass knows of the stack before an
+ * instruction, on every path that reaches it
+ * @depth: The stack holds at least this many values
+ * @known: The top @n_known values, top first
+ * @n_known: Number of values in @known, never more than @depth
+ * @mode: STACK, QUEUE, or -1 if it depends on the path
+ */
+typedef struct dce_s
+{
+	size_t depth;
+	int known[DCE_KNOWN];
+	int n_known;
+	int mode;
+} dce_t;
+
+/* LEX_DELIMS - Delimiter sets up to this size are matched with SIMD */
+#define LEX_DELIMS 8
+/* LEX_SPANS - Words strtow finds on the stack before it needs malloc */
+#define LEX_SPANS 8
+
+/**
+ * struct lex_set_s - A delimiter set prepared for lex_scan
+ * @bits: One bit per byte value, set for delimiters (scalar lexer)
+ * @c: The delimiters (SIMD lexer)
+ * @n: Number of delimiters in @c, or more than LEX_DELIMS if too many
+ */
+typedef struct lex_set_s
+{
+	uint64_t bits[4];
+	char c[LEX_DELIMS];
+	int n;
+} lex_set_t;
+
+/**
+ * struct lex_span_s - A word found by lex_scan
+ * @off: Offset of its first byte from the start of the string
+ * @len: Its length
+ */
+typedef struct lex_span_s
+{
+	size_t off;
+	size_t len;
+} lex_span_t;
+
+#define CACHE_MAGIC "MONTYC\0\0"
+/* CACHE_VERSION - Bump whenever the decoded form or opcode numbering changes */
+#define CACHE_VERSION (5UL << 24 | OP_COUNT << 16 | sizeof(instr_t))
+
+/**
+ * struct cache_hdr_s - Header of a decoded program in the disk cache
+ * @magic: CACHE_MAGIC
+ * @version: CACHE_VERSION of the interpreter that wrote the entry
+ * @hash: hash_bytes of the source
+ * @src_len: Length of the source, stored after the names
+ * @n_code: Number of instructions, stored right after the header
+ * @n_names: Number of names, stored NUL-terminated after the instructions
+ * @names_len: Total length of the names, NUL bytes included
+ * @n_pool: Number of ints in the pool, stored between the instructions
+ * and the names
+ * @nul_tail: The program's nul_tail
+ * @sum: hash_bytes of the instructions and names, so a damaged entry is
+ * a miss
+ */
+typedef struct cache_hdr_s
+{
+	char magic[8];
+	unsigned long version;
+	unsigned long hash;
+	unsigned long src_len;
+	unsigned long n_code;
+	unsigned long n_names;
+	unsigned long names_len;
+	unsigned long n_pool;
+	unsigned long nul_tail;
+	unsigned long sum;
+} cache_hdr_t;
+
+/**
+ * struct input_s - The stdin buffer of read and readall
+ * @buf: Bytes read from stdin, with a NUL after the last one
+ * @pos: Index in @buf of the next unparsed byte
+ * @len: Number of bytes in @buf
+ * @mark: Index in @buf of the integer being parsed, kept by input_fill
+ * @eof: Set once stdin is exhausted
+ * @fd: Descriptor of stdin; a --green VM reads its client's
+ * @off: Number of bytes read from @fd so far
+ * @yield: Return INPUT_WAIT rather than wait for @fd (--green)
+ */
+typedef struct input_s
+{
+	char buf[INPUT_BUF + 1];
+	size_t pos;
+	size_t len;
+	size_t mark;
+	int eof;
+	int fd;
+	unsigned long off;
+	int yield;
+} input_t;
+
+/**
+ * struct vm_s - Execution state of the running Monty program
+ * @prog: The decoded program
+ * @ip: Index of the next instruction to execute
+ * @arg: Operand of the instruction currently executing
+ * @status: EXIT_SUCCESS, or the exit code set by a failing opcode
+ * @mem: Bytes allocated for the values of all stacks
+ * @ret: Return stack of call: the instruction index after each active call
+ * @rsp: Number of entries on @ret
+ * @in: Buffered stdin of read and readall
+ */
+typedef struct vm_s
+{
+	prog_t *prog;
+	size_t ip;
+	int arg;
+	int status;
+	size_t mem;
+	size_t ret[RET_DEPTH];
+	size_t rsp;
+	input_t *in;
+} vm_t;
+
+/**
+ * struct opts_s - Command-line options of the interpreter
+ * @jit: Run programs as x86-64 code from the template JIT when possible
+ * @emit_c: Print programs as standalone C source instead of running them
+ * @bf: 1 to read Brainfuck instead of Monty, 2 for unoptimized Brainfuck
+ * @serve: Socket path of the daemon to run (--serve), or NULL
+ * @submit: Socket path of the daemon to send the script to, or NULL
+ * @green: Interleave the jobs of each daemon worker (--green)
+ * @timeout: Seconds a daemon job may run before it is stopped, or 0
+ * @cache: Keep decoded programs in the disk cache (--cache)
+ * @script: Path of the script being run
+ * @ckpt_every: Snapshot the VM every this many instructions, or 0
+ * @resume: Snapshot to continue the script from (--resume), or NULL
+ * @trace: File to record an execution trace to (--trace), or NULL
+ * @trace_decode: Print the trace file given as script as text
+ * @incremental: Resume edited scripts from cached prefix states
+ * @max_depth: Most values any one stack may hold, or 0
+ * @max_memory: Most bytes all stacks may allocate for values, or 0
+ * @spill: Page the bottom of stacks out to disk past @max_memory
+ * @no_dce: Keep trailing instructions that cannot affect the run
+ */
+typedef struct opts_s
+{
+	int jit;
+	int emit_c;
+	int bf;
+	char *serve;
+	char *submit;
+	int green;
+	unsigned long timeout;
+	int cache;
+	char *script;
+	unsigned long ckpt_every;
+	char *resume;
+	char *trace;
+	int trace_decode;
+	int incremental;
+	size_t max_depth;
+	size_t max_memory;
+	int spill;
+	int no_dce;
+} opts_t;
+
+#define INC_MAGIC "MONTYI\0\0"
+#define INC_SNAPS 16
+#define INC_EVERY 256
+/* INC_MAX_VALS - Snapshots of stack banks holding more values are skipped */
+#define INC_MAX_VALS (1 << 20)
+/* INC_MAX_OUT - Runs printing more stop taking snapshots */
+#define INC_MAX_OUT (1 << 26)
+
+/**
+ * struct inc_hdr_s - Header of an --incremental session file, followed by
+ * the inc_snap_t of each snapshot (without @data), their data, then the
+ * output of the run up to its last snapshot
+ * @magic: INC_MAGIC
+ * @version: CACHE_VERSION of the interpreter that wrote the file
+ * @n: Number of snapshots
+ * @every: Instructions between snapshots
+ * @out: Number of output bytes
+ * @sum: inc_sum of the rest of the file
+ */
+typedef struct inc_hdr_s
+{
+	char magic[8];
+	unsigned long version;
+	unsigned long n;
+	unsigned long every;
+	unsigned long out;
+	unsigned long sum;
+} inc_hdr_t;
+
+/**
+ * struct inc_snap_s - VM state at an instruction boundary of a script
+ * @hash: Prefix hash of the program before the boundary (see inc_prefix)
+ * @ip: Index of the instruction after the boundary
+ * @out: Number of bytes the script printed before the boundary
+ * @size: Size of @data
+ * @data: The selected stack index, then for each stack of the bank its
+ * mode, its length (as unsigned longs) and its values, top first
+ */
+typedef struct inc_snap_s
+{
+	unsigned long hash;
+	unsigned long ip;
+	unsigned long out;
+	unsigned long size;
+	unsigned char *data;
+} inc_snap_t;
+
+/**
+ * struct inc_s - State of an --incremental run
+ * @prefix: Prefix hash of every instruction boundary
+ * @snaps: Snapshots, in instruction order
+ * @n: Number of snapshots
+ * @every: Instructions between snapshots; doubles when @snaps fills up
+ * @next: Instruction index of the next snapshot
+ * @recording: Cleared once the state may depend on more than the
+ * instructions executed so far (after a jump or a read from stdin)
+ * @out: Everything printed while recording
+ * @out_len: Length of @out
+ * @out_cap: Allocated size of @out
+ * @path: The session file of the script
+ */
+typedef struct inc_s
+{
+	unsigned long *prefix;
+	inc_snap_t snaps[INC_SNAPS];
+	int n;
+	unsigned long every;
+	unsigned long next;
+	int recording;
+	char *out;
+	size_t out_len;
+	size_t out_cap;
+	char path[4096];
+} inc_t;
+
+#define TRACE_MAGIC "MONTYT\0\0"
+#define TRACE_BLOCK 65536
+#define TRACE_RING 8
+/* TRACE_REC_MAX - Longest encoding of one record: a flag byte, 3 varints */
+#define TRACE_REC_MAX 31
+#define TRACE_BEFORE_EMPTY 0x80
+#define TRACE_AFTER_EMPTY 0x40
+/* TRACE_NONE - Passed to trace_record as the top of an empty stack */
+#define TRACE_NONE (-1L - 0x7fffffffL - 1)
+
+/**
+ * struct trace_s - An execution trace being recorded
+ * @ring: TRACE_RING blocks of TRACE_BLOCK bytes; the VM fills block
+ * head % TRACE_RING while the writer thread drains blocks tail to head
+ * @lens: Number of bytes used in each block
+ * @counts: Number of records in each block
+ * @head: Number of blocks handed to the writer
+ * @tail: Number of blocks written out
+ * @pos: Bytes used in the block being filled
+ * @n: Records in the block being filled
+ * @line: Line of the previous record in the block (delta base)
+ * @tos: Top of stack after the previous record in the block (delta base)
+ * @fd: The trace file
+ * @done: Set once the VM has handed over its last block
+ * @failed: Set by the writer thread if a write fails
+ * @thread: The writer thread
+ * @lock: Protects head, tail, done and failed
+ * @cond: Signalled whenever head, tail or done change
+ *
+ * Description: The file is TRACE_MAGIC followed by blocks, each a 4-byte
+ * length and a 4-byte record count, then the records. A record is a byte
+ * holding the opcode and the TRACE_*_EMPTY flags, then zigzag varints of
+ * the line delta, the top of stack before (unless empty) relative to the
+ * last top after, and the top after (unless empty) relative to the last
+ * top. Deltas restart from 0 in every block.
+ */
+typedef struct trace_s
+{
+	unsigned char *ring;
+	size_t lens[TRACE_RING];
+	unsigned long counts[TRACE_RING];
+	unsigned long head;
+	unsigned long tail;
+	size_t pos;
+	unsigned long n;
+	long line;
+	long tos;
+	int fd;
+	int done;
+	int failed;
+	pthread_t thread;
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+} trace_t;
+
+#define CKPT_MAGIC "MONTYS\0\0"
+/* CKPT_NO_START - ckpt_hdr_t.start of a run whose stdout could not seek */
+#define CKPT_NO_START (~0UL)
+
+/**
+ * struct ckpt_hdr_s - Header of a VM snapshot
+ * @magic: CKPT_MAGIC
+ * @version: CACHE_VERSION of the interpreter that wrote the snapshot
+ * @sum: cache_sum of the program, so a snapshot only resumes its script
+ * @ip: Index of the next instruction to execute
+ * @cur: Index in the bank of the selected stack; each stack of the bank
+ * follows the header, written by ckpt_write_stack as {mode, len} and
+ * then its values
+ * @start: Offset in stdout where the run's output began, or CKPT_NO_START
+ * @out: Number of bytes written to stdout so far
+ * @in: Number of bytes of stdin read and used so far
+ * @rsp: Number of return addresses, written after the stacks and
+ * followed by the map
+ */
+typedef struct ckpt_hdr_s
+{
+	char magic[8];
+	unsigned long version;
+	unsigned long sum;
+	unsigned long ip;
+	unsigned long cur;
+	unsigned long start;
+	unsigned long out;
+	unsigned long in;
+	unsigned long rsp;
+} ckpt_hdr_t;
+
+/**
+ * struct ckpt_s - State of a checkpointed run
+ * @sum: cache_sum of the program
+ * @path: Where snapshots are written
+ * @pid: The child writing the last snapshot, or 0
+ * @start: Offset in stdout where the run's output began, or CKPT_NO_START
+ * @out: Number of bytes written to stdout so far
+ * @seek: Non-zero if stdin can seek, so snapshots can record its offset
+ */
+typedef struct ckpt_s
+{
+	unsigned long sum;
+	char *path;
+	pid_t pid;
+	unsigned long start;
+	unsigned long out;
+	int seek;
+} ckpt_t;
+
+/**
+ * struct jit_fix_s - A rel32 operand to patch once the JIT knows its target
+ * @pos: Offset of the rel32 in the code buffer
+ * @kind: JIT_FIX_IP for a jump to an instruction, else the error stub kind
+ * (jit_jump also takes JIT_AT for a target offset that is already known)
+ * @value: Target instruction index, or the OP_* index for the stub message
+ * @line: Source line for the stub message
+ */
+typedef struct jit_fix_s
+{
+	size_t pos;
+	int kind;
+	int value;
+	unsigned int line;
+} jit_fix_t;
+
+#define JIT_FIX_IP 0
+#define JIT_FIX_POP 1
+#define JIT_FIX_PINT 2
+#define JIT_FIX_SHORT 3
+#define JIT_FIX_DIV 4
+#define JIT_FIX_EMPTY 5
+#define JIT_AT (-1)
+
+/**
+ * struct jit_s - State of the template JIT while it compiles a program
+ * @code: Executable buffer (mmap'ed, writable until compilation ends)
+ * @len: Bytes emitted so far
+ * @cap: Size of @code
+ * @addr: Offset in @code of each instruction, plus one for the exit
+ * @table: Absolute address of each instruction, for computed jumps
+ * @fix: Pending rel32 operands
+ * @n_fix: Number of entries in @fix
+ * @fix_cap: Allocated size of @fix
+ * @epilogue: Offset of the code returning to C with the status in eax
+ * @fail: Offset of the code returning vm.status after a failed fallback
+ * @dispatch: Offset of the computed jump to the instruction index in rax
+ * @failed: Set when the code buffer overflows or malloc fails
+ */
+typedef struct jit_s
+{
+	unsigned char *code;
+	size_t len;
+	size_t cap;
+	size_t *addr;
+	size_t *table;
+	jit_fix_t *fix;
+	size_t n_fix;
+	size_t fix_cap;
+	size_t epilogue;
+	size_t fail;
+	size_t dispatch;
+	int failed;
+} jit_t;
+
+/*
+ * SERVE_FDS - Descriptors a client passes: stdout, stderr, stdin and its
+ * working directory
+ */
+#define SERVE_FDS 4
+/* SERVE_TIMEOUT - Default --timeout: seconds a daemon job may run */
+#define SERVE_TIMEOUT 300
+#define SERVE_TIMEOUT_MSG "Error: Job timed out after %lu seconds\n"
+#define SERVE_CACHE 64
+#define SERVE_ARENA_MAX (1 << 20)
+
+/**
+ * struct cache_ent_s - A decoded program kept by a daemon worker
+ * @hash: hash_bytes of the source
+ * @src: The source, compared on lookup so that a hash collision is a miss
+ * @len: Length of @src
+ * @prog: The decoded program
+ * @users: Number of --green VMs running @prog; it is not replaced until 0
+ */
+typedef struct cache_ent_s
+{
+	unsigned long hash;
+	char *src;
+	size_t len;
+	prog_t prog;
+	size_t users;
+} cache_ent_t;
+
+/**
+ * struct serve_s - State a daemon worker keeps between jobs
+ * @stack: The stack_t reused by every job, so its ring buffer stays warm
+ * @cache: Direct-mapped cache of decoded programs, indexed by hash
+ * @devnull: Descriptor of /dev/null, for stdout and stderr between jobs
+ * @home: Descriptor of the daemon's working directory, for between jobs
+ */
+typedef struct serve_s
+{
+	stack_t *stack;
+	cache_ent_t cache[SERVE_CACHE];
+	int devnull;
+	int home;
+} serve_t;
+
+/* GREEN_QUANTUM - Instructions a --green VM runs before it yields */
+#define GREEN_QUANTUM 4096
+/* GREEN_MAX - Most VMs a --green worker runs at once */
+#define GREEN_MAX 4096
+/* GREEN_ACCEPT - Most jobs a --green worker takes on between two rounds */
+#define GREEN_ACCEPT 64
+/* GREEN_OUT - Output a --green VM buffers before writing it to its client */
+#define GREEN_OUT (1 << 16)
+
+/**
+ * struct green_buf_s - Output of a --green VM on its way to its client
+ * @fd: The client's descriptor
+ * @data: Bytes not written yet
+ * @len: Number of bytes in @data
+ * @cap: Allocated size of @data
+ */
+typedef struct green_buf_s
+{
+	int fd;
+	char *data;
+	size_t len;
+	size_t cap;
+} green_buf_t;
+
+/**
+ * struct green_s - A suspended VM of a --green worker, with the part of
+ * vm that belongs to one job
+ * @prog: The program it runs
+ * @own: @prog when the program is not in the worker's cache
+ * @ent: The cache entry of @prog, or NULL
+ * @stack: The selected stack_t of its bank; the mode lives in there
+ * @ip: Index of the next instruction to execute
+ * @status: EXIT_SUCCESS, or the exit code set by a failing opcode
+ * @mem: Bytes allocated for the values of its stacks
+ * @ret: Its return stack, @rsp entries of vm.ret
+ * @rsp: Number of entries on @ret
+ * @ret_cap: Allocated size of @ret
+ * @conn: Connection to the client, for the exit status
+ * @out: Its stdout
+ * @err: Its stderr
+ * @in: Its stdin
+ * @waiting: Set while it waits for its stdin to be ready
+ * @dir: Its client's working directory
+ * @deadline: green_clock time it is stopped at, or 0 for never
+ * @next: Next free context, while it is on the free list
+ */
+typedef struct green_s
+{
+	prog_t *prog;
+	prog_t own;
+	cache_ent_t *ent;
+	stack_t *stack;
+	size_t ip;
+	int status;
+	size_t mem;
+	size_t *ret;
+	size_t rsp;
+	size_t ret_cap;
+	int conn;
+	green_buf_t out;
+	green_buf_t err;
+	input_t *in;
+	int waiting;
+	int dir;
+	unsigned long deadline;
+	struct green_s *next;
+} green_t;
+
+/**
+ * struct sched_s - The scheduler of a --green worker
+ * @serve: The worker state, for its program cache
+ * @run: The running VMs, in round-robin order
+ * @n_run: Number of entries in @run
+ * @free: Contexts of finished jobs, kept with their warm stacks
+ * @cur: The VM whose slice is running; stdout and stderr go to it
+ */
+typedef struct sched_s
+{
+	serve_t *serve;
+	green_t *run[GREEN_MAX];
+	size_t n_run;
+	green_t *free;
+	green_t *cur;
+} sched_t;
+
+/* JIT_EMIT - Appends the bytes of a string literal to the JIT buffer */
+#define JIT_EMIT(j, s) jit_emit((j), (s), sizeof(s) - 1)
+/* JIT_DROP - "inc r13; and r13, r15; dec r14": drops the top value */
+#define JIT_DROP "\x49\xff\xc5\x4d\x21\xfd\x49\xff\xce"
+
+extern instruction_t op_table[];
+extern vm_t vm;
+extern opts_t opts;
+
 void free_stack(stack_t **stack);
 int init_stack(stack_t **stack);
 int check_mode(stack_t *stack);
+int stack_grow(stack_t *stack);
+int stack_push(stack_t *stack, int n);
+int stack_room(stack_t *stack);
+int stack_rotate(stack_t *stack, long k);
+int stack_push_n(stack_t *stack, const int *vals, size_t n);
+
+int spill_run(prog_t *prog, stack_t **stack);
+int spill_fill(stack_t *stack);
+int spill_out(stack_t *stack);
+int spill_push(stack_t *stack, int n);
+int spill_pop(stack_t *stack, int *n);
+int spill_rotate(stack_t *stack, long k);
+int spill_print(stack_t *stack, int str);
+int spill_print_vals(int *vals, size_t len, int str);
+int spill_new(stack_t *stack);
+void spill_free(stack_t *stack);
+int spill_store(spill_t *sp, int *vals, size_t len, int front);
+int spill_read(spill_t *sp, size_t i, int *vals);
+int spill_take(spill_t *sp, int front, int *vals, size_t *len);
+int spill_reach(stack_t *stack, size_t depth);
+int spill_peek(stack_t *stack, size_t depth, int *n);
 void free_tokens(void);
 unsigned int token_arr_len(void);
 int run_monty(FILE *script_fd);
-void set_op_tok_error(int error_code);
+void set_op_error(int error_code);
+int get_op_code(char *opcode);
+int exec_program(prog_t *prog, stack_t **stack);
+
+int load_program(FILE *script_fd, prog_t *prog);
+int is_empty_line(char *line, char *delims);
+int decode_line(prog_t *prog, char *line, unsigned int line_number);
+int emit_instr(prog_t *prog, int op, int arg, unsigned int line);
+int intern_name(prog_t *prog, char *name);
+int pool_reserve(prog_t *prog, size_t n);
+int decode_pushs(prog_t *prog, char *line, unsigned int line_number);
+int decode_pushn(prog_t *prog, unsigned int line_number);
+int pool_escape(char **p);
+void free_program(prog_t *prog);
+int load_program_mem(char *src, size_t len, prog_t *prog);
+int add_label(prog_t *prog, char *name, unsigned int line);
+int resolve_labels(prog_t *prog);
+int match_defs(prog_t *prog);
+int load_parallel(FILE *script_fd, prog_t *prog);
+int parse_parallel(const char *src, size_t len, prog_t *prog);
+void *parse_chunk(void *arg);
+int parse_line(parse_chunk_t *c, char *line);
+int parse_stitch(parse_chunk_t *chunks, int n, prog_t *prog);
+int bf_compile(FILE *bf_fd, prog_t *prog, int optimize);
+long bf_emit_run(prog_t *prog, char *src, size_t n, unsigned int line,
+		 int optimize);
+long bf_emit_idiom(prog_t *prog, char *src, size_t n, unsigned int line);
+int run_bf(FILE *bf_fd, int optimize);
+
+int jit_exec(prog_t *prog, stack_t **stack);
+int jit_compile(prog_t *prog, jit_t *j);
+long jit_fallback(stack_t **stack, size_t ip);
+void jit_free(jit_t *j);
+void jit_finish(jit_t *j, prog_t *prog);
+void jit_emit(jit_t *j, const char *bytes, size_t n);
+void jit_imm(jit_t *j, size_t value, size_t n);
+void jit_imm_at(jit_t *j, size_t pos, size_t value);
+void jit_mem(jit_t *j, const char *op, size_t n, int reg, int index);
+void jit_rbx(jit_t *j, const char *op, size_t n, size_t offset);
+void jit_call(jit_t *j, size_t fn);
+void jit_jump(jit_t *j, const char *op, size_t n, int kind, int value,
+	      unsigned int line);
+void jit_need(jit_t *j, size_t depth, int kind, instr_t *in);
+void jit_spill(jit_t *j);
+void jit_reload(jit_t *j);
+void jit_slow(jit_t *j, size_t ip);
+void jit_instr(jit_t *j, prog_t *prog, size_t ip);
+void jit_push(jit_t *j, instr_t *in, size_t ip);
+void jit_swap(jit_t *j, instr_t *in);
+void jit_arith(jit_t *j, instr_t *in);
+void jit_print(jit_t *j, instr_t *in);
+void jit_branch(jit_t *j, instr_t *in);
+void jit_prologue(jit_t *j);
+
+int emit_c(prog_t *prog, FILE *out, int bf);
+void emit_c_prelude(FILE *out);
+void emit_c_str(FILE *out, char *str);
+void emit_c_check(FILE *out, char *cond, unsigned int line, char *what);
+void emit_c_bank(instr_t *in, FILE *out);
+void emit_c_call(prog_t *prog, instr_t *in, FILE *out);
+void emit_c_returns(prog_t *prog, FILE *out);
+void emit_c_pool(prog_t *prog, instr_t *in, FILE *out);
+void emit_c_index(instr_t *in, FILE *out);
+void emit_c_read(instr_t *in, FILE *out);
+void emit_c_file(prog_t *prog, instr_t *in, FILE *out);
+void emit_c_check2(FILE *out, char *cond, unsigned int line, char *what);
+void emit_c_map(instr_t *in, FILE *out);
+void emit_c_instr(prog_t *prog, instr_t *in, FILE *out);
+void emit_c_math(instr_t *in, FILE *out);
+void emit_c_print(instr_t *in, FILE *out);
+void emit_c_jump(instr_t *in, FILE *out);
+void emit_c_bf(instr_t *in, FILE *out);
+
+unsigned long hash_bytes(const char *buf, size_t len);
+int read_full(int fd, void *buf, size_t len);
+int write_full(int fd, const void *buf, size_t len);
+char *read_stream(FILE *stream, size_t *len);
+int parse_args(int argc, char **argv, char **file);
+
+int monty_serve(char *path);
+void serve_spawn(int listen_fd);
+void serve_worker(int listen_fd);
+void serve_job(serve_t *s, int c);
+void serve_alarm(int sig);
+prog_t *serve_lookup(serve_t *s, char *src, size_t len);
+int serve_recv_hdr(int c, unsigned long *len, int *fds);
+int serve_reset(stack_t **stack);
+cache_ent_t *serve_slot(serve_t *s, char *src, size_t len, int *hit);
+void green_loop(serve_t *s, int listen_fd);
+void green_accept(sched_t *g, int listen_fd);
+green_t *green_new(sched_t *g);
+void green_start(sched_t *g, int c);
+int green_slice(green_t *t);
+unsigned long green_clock(void);
+void green_wait(sched_t *g, int listen_fd);
+void green_round(sched_t *g);
+void green_finish(sched_t *g, green_t *t);
+int green_flush(green_buf_t *b);
+int green_put(green_buf_t *b, const char *buf, size_t size);
+ssize_t green_out_write(void *cookie, const char *buf, size_t size);
+ssize_t green_err_write(void *cookie, const char *buf, size_t size);
+int serve_socket(char *path, struct sockaddr_un *addr);
+int submit_send_hdr(int c, unsigned long len, int dir);
+int monty_submit(char *path, char *file);
+
+int load_cached(FILE *script_fd, prog_t *prog);
+int cache_path(char *buf, size_t size, unsigned long hash, char *ext);
+int cache_load(char *path, char *src, size_t len, prog_t *prog);
+unsigned long cache_sum(prog_t *prog);
+
+int ckpt_run(prog_t *prog, stack_t **stack);
+void ckpt_fork(ckpt_t *ck, stack_t *stack);
+int ckpt_write(ckpt_t *ck, stack_t *stack);
+int ckpt_write_stack(int fd, stack_t *s);
+int ckpt_write_map(int fd, map_t *map);
+ssize_t ckpt_out_write(void *cookie, const char *buf, size_t size);
+int ckpt_resume(ckpt_t *ck, stack_t **stack);
+int ckpt_restore_out(ckpt_t *ck);
+unsigned long ckpt_out_start(void);
+int ckpt_read_stack(int fd, stack_t *s);
+int ckpt_read_map(int fd, map_t **map);
+
+int inc_run(prog_t *prog, stack_t **stack);
+int inc_prefix(inc_t *inc, prog_t *prog);
+void inc_snap(inc_t *inc, stack_t *stack);
+ssize_t inc_out_write(void *cookie, const char *buf, size_t size);
+void inc_free(inc_t *inc);
+void inc_load(inc_t *inc, stack_t **stack, prog_t *prog);
+int inc_restore(inc_snap_t *snap, stack_t **stack);
+void inc_save(inc_t *inc);
+unsigned long inc_sum(inc_t *inc, int n, char *out, size_t len);
+
+int trace_run(prog_t *prog, stack_t **stack);
+void trace_record(trace_t *t, instr_t *in, long before, stack_t *after);
+void trace_flush(trace_t *t);
+int trace_open(trace_t *t, char *path);
+void *trace_writer(void *arg);
+int trace_close(trace_t *t);
+int trace_decode(FILE *trace_fd);
+unsigned char *trace_put(unsigned char *p, long v);
+int trace_get(FILE *f, long *v);
+int trace_print(FILE *f, unsigned long count);
+int cache_map(prog_t *prog, char *map, cache_hdr_t *hdr);
+int cache_store(char *path, char *src, size_t len, prog_t *prog);
+int cache_check(prog_t *prog);
 
 void monty_push(stack_t **stack, unsigned int line_number);
 void monty_pall(stack_t **stack, unsigned int line_number);
@@ -68,9 +1043,71 @@ void monty_rotl(stack_t **stack, unsigned int line_number);
 void monty_rotr(stack_t **stack, unsigned int line_number);
 void monty_stack(stack_t **stack, unsigned int line_number);
 void monty_queue(stack_t **stack, unsigned int line_number);
+void monty_rotn(stack_t **stack, unsigned int line_number);
+void monty_jmp(stack_t **stack, unsigned int line_number);
+void monty_jz(stack_t **stack, unsigned int line_number);
+void monty_jnz(stack_t **stack, unsigned int line_number);
+void monty_loop(stack_t **stack, unsigned int line_number);
+void monty_select(stack_t **stack, unsigned int line_number);
+void monty_movto(stack_t **stack, unsigned int line_number);
+void monty_movfrom(stack_t **stack, unsigned int line_number);
+void monty_def(stack_t **stack, unsigned int line_number);
+void monty_end(stack_t **stack, unsigned int line_number);
+void monty_call(stack_t **stack, unsigned int line_number);
+void monty_ret(stack_t **stack, unsigned int line_number);
+void monty_push_pool(stack_t **stack, unsigned int line_number);
+void monty_dup(stack_t **stack, unsigned int line_number);
+void monty_over(stack_t **stack, unsigned int line_number);
+void monty_pick(stack_t **stack, unsigned int line_number);
+void monty_roll(stack_t **stack, unsigned int line_number);
+void monty_drop(stack_t **stack, unsigned int line_number);
+int stack_reach(stack_t *stack, size_t depth, unsigned int line_number,
+		char *op);
+void monty_read(stack_t **stack, unsigned int line_number);
+void monty_readall(stack_t **stack, unsigned int line_number);
+int input_fill(input_t *in);
+int input_int(input_t *in, int *n);
+void input_reset(input_t *in, int fd, int yield);
+void monty_load(stack_t **stack, unsigned int line_number);
+void monty_save(stack_t **stack, unsigned int line_number);
+int stack_load(stack_t *stack, const int *vals, size_t n);
+int stack_save(stack_t *stack, int fd);
+int save_ring(stack_t *stack, int fd, int rev);
+int save_spill(stack_t *stack, int fd, int rev);
+void monty_store(stack_t **stack, unsigned int line_number);
+void monty_fetch(stack_t **stack, unsigned int line_number);
+void monty_has(stack_t **stack, unsigned int line_number);
+void monty_del(stack_t **stack, unsigned int line_number);
+int map_put(map_t **map, int key, int val);
+int *map_get(map_t *map, int key);
+size_t map_slot(map_t *map, int key);
+int map_del(map_t *map, int key);
+int map_grow(map_t *map);
+void map_free(map_t **map);
+void dce_trim(prog_t *prog);
+void dce_clamp(prog_t *prog, size_t cut);
+int dce_step(dce_t *st, prog_t *prog, instr_t *in);
+int dce_index(dce_t *st, instr_t *in);
+int dce_math(dce_t *st, instr_t *in);
+void dce_push(dce_t *st, int is_known, int n);
+void dce_pop(dce_t *st, size_t n);
+int dce_need(dce_t *st, size_t n);
+void dce_reset(dce_t *st);
+void monty_bad_op(stack_t **stack, unsigned int line_number);
+void monty_bad_arg(stack_t **stack, unsigned int line_number);
+void bf_add(stack_t **stack, unsigned int line_number);
+void bf_out(stack_t **stack, unsigned int line_number);
+void bf_in(stack_t **stack, unsigned int line_number);
+void bf_clear(stack_t **stack, unsigned int line_number);
+void bf_mul(stack_t **stack, unsigned int line_number);
 
 char **strtow(char *str, char *delims);
+char **copy_words(char *str, lex_span_t *spans, size_t wc);
+void lex_init(lex_set_t *set, const char *delims);
+size_t lex_scan(const char *str, const lex_set_t *set, lex_span_t *spans,
+		size_t max);
 char *get_int(int n);
+int is_int_str(char *str);
 
 
 int usage_error(void);
@@ -83,6 +1120,18 @@ int pint_error(unsigned int line_number);
 int short_stack_error(unsigned int line_number, char *op);
 int div_error(unsigned int line_number);
 int pchar_error(unsigned int line_number, char *message);
+int arg_error(unsigned int line_number, char *op, char *kind);
+int empty_stack_error(unsigned int line_number, char *op);
+int label_error(unsigned int line_number, char *message, char *label);
+int sock_error(char *path);
+int resume_error(char *path);
+int write_error(char *filename);
+int limit_error(int status, unsigned int line_number, char *opcode);
+int call_error(unsigned int line_number, char *op, char *message);
+int file_error(int status, unsigned int line_number, char *op, char *path);
+int key_error(unsigned int line_number, char *op);
+int timeout_error(void);
+int chdir_error(void);
 
 
 #endif
@@ -3,10 +3,73 @@
 
 void free_tokens(void);
 unsigned int token_arr_len(void);
-int is_empty_line(char *line, char *delims);
-void (*get_op_func(char *opcode))(stack_t**, unsigned int);
+int get_op_code(char *opcode);
+int exec_program(prog_t *prog, stack_t **stack);
 int run_monty(FILE *script_fd);
 
+/*
+ * op_table - Every opcode the interpreter knows, indexed by enum op_id.
+ * Entries from OP_BAD_OP on are internal and are never looked up by name.
+ */
+instruction_t op_table[] = {
+	{"push", monty_push, OPND_INT},
+	{"pall", monty_pall, OPND_NONE},
+	{"pint", monty_pint, OPND_NONE},
+	{"pop", monty_pop, OPND_NONE},
+	{"swap", monty_swap, OPND_NONE},
+	{"add", monty_add, OPND_NONE},
+	{"nop", monty_nop, OPND_NONE},
+	{"sub", monty_sub, OPND_NONE},
+	{"div", monty_div, OPND_NONE},
+	{"mul", monty_mul, OPND_NONE},
+	{"mod", monty_mod, OPND_NONE},
+	{"pchar", monty_pchar, OPND_NONE},
+	{"pstr", monty_pstr, OPND_NONE},
+	{"rotl", monty_rotl, OPND_NONE},
+	{"rotr", monty_rotr, OPND_NONE},
+	{"stack", monty_stack, OPND_NONE},
+	{"queue", monty_queue, OPND_NONE},
+	{"rotn", monty_rotn, OPND_INT},
+	{"jmp", monty_jmp, OPND_LABEL},
+	{"jz", monty_jz, OPND_LABEL},
+	{"jnz", monty_jnz, OPND_LABEL},
+	{"loop", monty_loop, OPND_LABEL},
+	{"select", monty_select, OPND_STACK},
+	{"movto", monty_movto, OPND_STACK},
+	{"movfrom", monty_movfrom, OPND_STACK},
+	{"def", monty_def, OPND_NONE},
+	{"end", monty_end, OPND_NONE},
+	{"call", monty_call, OPND_LABEL},
+	{"ret", monty_ret, OPND_NONE},
+	{"pushs", monty_push_pool, OPND_STRING},
+	{"pushn", monty_push_pool, OPND_LIST},
+	{"dup", monty_dup, OPND_NONE},
+	{"over", monty_over, OPND_NONE},
+	{"pick", monty_pick, OPND_INDEX},
+	{"roll", monty_roll, OPND_INDEX},
+	{"drop", monty_drop, OPND_INDEX},
+	{"read", monty_read, OPND_NONE},
+	{"readall", monty_readall, OPND_NONE},
+	{"load", monty_load, OPND_PATH},
+	{"save", monty_save, OPND_PATH},
+	{"store", monty_store, OPND_NONE},
+	{"fetch", monty_fetch, OPND_NONE},
+	{"has", monty_has, OPND_NONE},
+	{"del", monty_del, OPND_NONE},
+	{"bad_op", monty_bad_op, OPND_NONE},
+	{"bad_arg", monty_bad_arg, OPND_NONE},
+	{"bf_add", bf_add, OPND_INT},
+	{"bf_out", bf_out, OPND_NONE},
+	{"bf_in", bf_in, OPND_NONE},
+	{"bf_clear", bf_clear, OPND_NONE},
+	{"bf_mul", bf_mul, OPND_INT},
+	{NULL, NULL, OPND_NONE}
+};
+
+/* std_in - The stdin buffer vm.in points to outside --green workers */
+static input_t std_in;
+vm_t vm = {NULL, 0, 0, EXIT_SUCCESS, 0, {0}, 0, &std_in};
+
 /**
  * free_tokens - Liberates the global op_toks string array gracefully.
  */
@@ -22,6 +85,7 @@ void free_tokens(void)
 		free(op_toks[i]);
 
 	free(op_toks);
+	op_toks = NULL;
 }
 
 /**
@@ -39,132 +103,114 @@ unsigned int token_arr_len(void)
 }
 
 /**
- * is_empty_line - Detects lines with only delimiters from a getline input.
- * @line: Pointer to the line.
- * @delims: String of delimiter characters.
+ * get_op_code - Resolves an opcode name to its index in op_table.
+ * @opcode: The opcode to be resolved.
  *
- * Return: 1 if the line consists solely of delimiters, 0 otherwise.
+ * Return: The OP_* index of the opcode, or -1 if it is unknown.
  */
-int is_empty_line(char *line, char *delims)
+int get_op_code(char *opcode)
 {
-	int i, j;
+	int i;
 
-	for (i = 0; line[i]; i++)
+	for (i = 0; i < OP_BAD_OP; i++)
 	{
-		for (j = 0; delims[j]; j++)
-		{
-			if (line[i] == delims[j])
-				break;
-		}
-		if (delims[j] == '\0')
-			return (0);
+		if (strcmp(opcode, op_table[i].opcode) == 0)
+			return (i);
 	}
 
-	return (1);
+	return (-1);
 }
 
 /**
- * get_op_func - Resolves opcodes to their respective operation functions.
- * @opcode: The opcode to be resolved.
+ * exec_program - Runs a decoded program on a stack.
+ * @prog: The decoded program.
+ * @stack: The stack_t the program operates on.
+ *
+ * With --jit the program runs as native code when it can be compiled.
  *
- * Return: pointer to the function that performs the specified operation.
+ * Return: EXIT_SUCCESS, or the exit code of the first opcode that failed.
  */
-void (*get_op_func(char *opcode))(stack_t**, unsigned int)
+int exec_program(prog_t *prog, stack_t **stack)
 {
-	instruction_t op_funcs[] = {
-		{"push", monty_push},
-		{"pall", monty_pall},
-		{"pint", monty_pint},
-		{"pop", monty_pop},
-		{"swap", monty_swap},
-		{"add", monty_add},
-		{"nop", monty_nop},
-		{"sub", monty_sub},
-		{"div", monty_div},
-		{"mul", monty_mul},
-		{"mod", monty_mod},
-		{"pchar", monty_pchar},
-		{"pstr", monty_pstr},
-		{"rotl", monty_rotl},
-		{"rotr", monty_rotr},
-		{"stack", monty_stack},
-		{"queue", monty_queue},
-		{NULL, NULL}
-	};
-	int i;
+	instr_t *in;
+	int status;
 
-	for (i = 0; op_funcs[i].opcode; i++)
+	if (opts.jit)
+	{
+		status = jit_exec(prog, stack);
+		if (status != -1)
+			return (status);
+	}
+	vm.prog = prog;
+	vm.ip = 0;
+	vm.rsp = 0;
+	vm.status = EXIT_SUCCESS;
+	while (vm.ip < prog->len)
 	{
-		if (strcmp(opcode, op_funcs[i].opcode) == 0)
-			return (op_funcs[i].f);
+		in = &prog->code[vm.ip++];
+		vm.arg = in->arg;
+		op_table[in->op].f(stack, in->line);
+		if (vm.status != EXIT_SUCCESS)
+			break;
 	}
 
-	return (NULL);
+	return (vm.status);
 }
 
 /**
  * run_monty - Executes a Monty script from the given file descriptor.
  * @script_fd: The mystical script parchment (file descriptor).
  *
+ * The whole script is decoded into an instruction array first; errors in
+ * individual lines (unknown opcodes, bad push operands) are kept as
+ * instructions so they are still reported when execution reaches them.
+ * Trailing instructions that can neither print nor fail are dropped.
+ *
  * Return: Returns EXIT_SUCCESS if the script is executed successfully;
  * otherwise, it returns the appropriate error code indicating failure.
  */
 int run_monty(FILE *script_fd)
 {
 	stack_t *stack = NULL;
-	char *line = NULL;
-	size_t len = 0, exit_status = EXIT_SUCCESS;
-	unsigned int line_number = 0, prev_tok_len = 0;
-	void (*op_func)(stack_t**, unsigned int);
-
-	if (init_stack(&stack) == EXIT_FAILURE)
+	prog_t prog;
+	int exit_status;
+
+	if (opts.cache)
+		exit_status = load_cached(script_fd, &prog);
+	else
+		exit_status = load_program(script_fd, &prog);
+	if (exit_status == EXIT_FAILURE)
+	{
+		free_program(&prog);
 		return (EXIT_FAILURE);
-
-	while (get_int(&line, &len, script_fd) != -1)
+	}
+	dce_trim(&prog);
+	if (opts.emit_c)
 	{
-		line_number++;
-		op_toks = strtow(line, DELIMS);
-		if (op_toks == NULL)
-		{
-			if (is_empty_line(line, DELIMS))
-				continue;
-			free_stack(&stack);
-			return (malloc_error());
-		}
-		else if (op_toks[0][0] == '#') /* comment line */
-		{
-			free_tokens();
-			continue;
-		}
-		op_func = get_op_func(op_toks[0]);
-		if (op_func == NULL)
-		{
-			free_stack(&stack);
-			exit_status = unknown_op_error(op_toks[0], line_number);
-			free_tokens();
-			break;
-		}
-		prev_tok_len = token_arr_len();
-		op_func(&stack, line_number);
-		if (token_arr_len() != prev_tok_len)
-		{
-			if (op_toks && op_toks[prev_tok_len])
-				exit_status = atoi(op_toks[prev_tok_len]);
-			else
-				exit_status = EXIT_FAILURE;
-			free_tokens();
-			break;
-		}
-		free_tokens();
+		exit_status = emit_c(&prog, stdout, 0);
+		free_program(&prog);
+		return (exit_status);
 	}
-	free_stack(&stack);
-
-	if (line && *line == 0)
+	if (init_stack(&stack) == EXIT_FAILURE)
 	{
-		free(line);
-		return (malloc_error());
+		free_program(&prog);
+		return (EXIT_FAILURE);
 	}
 
-	free(line);
+	if (opts.trace)
+		exit_status = trace_run(&prog, &stack);
+	else if (opts.ckpt_every || opts.resume)
+		exit_status = ckpt_run(&prog, &stack);
+	else if (opts.incremental)
+		exit_status = inc_run(&prog, &stack);
+	else if (opts.spill)
+		exit_status = spill_run(&prog, &stack);
+	else
+		exit_status = exec_program(&prog, &stack);
+	free_stack(&stack);
+	if (exit_status == EXIT_SUCCESS && prog.nul_tail)
+		exit_status = malloc_error();
+
+	free_program(&prog);
 	return (exit_status);
 }
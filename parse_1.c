@@ -0,0 +1,165 @@
+/* memrchr is a GNU extension */
+#define _GNU_SOURCE
+#include "monty.h"
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+int load_parallel(FILE *script_fd, prog_t *prog);
+int parse_parallel(const char *src, size_t len, prog_t *prog);
+void *parse_chunk(void *arg);
+int parse_line(parse_chunk_t *c, char *line);
+
+/**
+ * load_parallel - Decodes a large script file with one thread per core.
+ * @script_fd: The script, not read from yet.
+ * @prog: The program to fill in.
+ *
+ * Return: The result of parse_parallel, or PARSE_RETRY if the script is
+ * not a large regular file or can't be mapped.
+ */
+int load_parallel(FILE *script_fd, prog_t *prog)
+{
+	struct stat st;
+	void *src;
+	int status;
+
+	memset(prog, 0, sizeof(*prog));
+	if (fstat(fileno(script_fd), &st) == -1 || !S_ISREG(st.st_mode) ||
+	    st.st_size < PARSE_MIN || ftell(script_fd) != 0)
+		return (PARSE_RETRY);
+	src = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE,
+		   fileno(script_fd), 0);
+	if (src == MAP_FAILED)
+		return (PARSE_RETRY);
+	madvise(src, st.st_size, MADV_SEQUENTIAL);
+	status = parse_parallel(src, st.st_size, prog);
+	munmap(src, st.st_size);
+	return (status);
+}
+
+/**
+ * parse_parallel - Decodes a script held in memory with several threads.
+ * @src: The script.
+ * @len: Its length.
+ * @prog: The program to fill in.
+ *
+ * Description: The script is cut into one slice per core at line
+ * boundaries. Each thread decodes its slice as if it were a whole
+ * script, and parse_stitch then joins the slices, shifting line numbers,
+ * names and jump targets by what came before.
+ *
+ * Return: EXIT_SUCCESS, EXIT_FAILURE after printing an error, or
+ * PARSE_RETRY if it was not worth it or a slice hit an error that the
+ * sequential loader has to report in order.
+ */
+int parse_parallel(const char *src, size_t len, prog_t *prog)
+{
+	parse_chunk_t chunks[PARSE_THREADS];
+	pthread_t tids[PARSE_THREADS];
+	int spawned[PARSE_THREADS], i, status;
+	long n = sysconf(_SC_NPROCESSORS_ONLN);
+	const char *end, *cut, *last;
+
+	memset(prog, 0, sizeof(*prog));
+	if (n > PARSE_THREADS)
+		n = PARSE_THREADS;
+	if (n > (long)(len / (PARSE_MIN / 4)))
+		n = len / (PARSE_MIN / 4);
+	if (n < 2)
+		return (PARSE_RETRY);
+	memset(chunks, 0, sizeof(chunks));
+	for (i = 0, cut = src, end = src + len; i < n && cut < end; i++)
+	{
+		chunks[i].src = cut;
+		cut = i == n - 1 ? end : src + len / n * (i + 1);
+		if (cut < chunks[i].src)
+			cut = chunks[i].src;
+		cut = cut < end ? memchr(cut, '\n', end - cut) : NULL;
+		cut = cut ? cut + 1 : end;
+		chunks[i].len = cut - chunks[i].src;
+		spawned[i] = pthread_create(&tids[i], NULL, parse_chunk,
+					    &chunks[i]) == 0;
+		if (!spawned[i])
+			parse_chunk(&chunks[i]);
+	}
+	n = i;
+	for (i = 0; i < n; i++)
+		if (spawned[i])
+			pthread_join(tids[i], NULL);
+	status = parse_stitch(chunks, n, prog);
+	last = memrchr(src, '\n', len - 1);
+	prog->nul_tail = *(last ? last + 1 : src) == '\0';
+	return (status);
+}
+
+/**
+ * parse_chunk - Thread body decoding one slice of a script.
+ * @arg: The parse_chunk_t.
+ *
+ * Lines are handled exactly as load_program handles them. Lines that
+ * make load_program print an error stop the slice with PARSE_RETRY
+ * instead, so the whole script is decoded again in order.
+ *
+ * Return: NULL.
+ */
+void *parse_chunk(void *arg)
+{
+	parse_chunk_t *c = arg;
+	const char *p = c->src, *end = c->src + c->len, *eol;
+	char *line = NULL, *bigger;
+	size_t size = 0, n;
+
+	c->status = EXIT_SUCCESS;
+	while (p < end && c->status == EXIT_SUCCESS)
+	{
+		eol = memchr(p, '\n', end - p);
+		n = (eol ? eol + 1 : end) - p;
+		if (n + 1 > size)
+		{
+			size = n + 1 > 2 * size ? n + 1 : 2 * size;
+			bigger = realloc(line, size);
+			if (bigger == NULL)
+			{
+				c->status = PARSE_RETRY;
+				break;
+			}
+			line = bigger;
+		}
+		memcpy(line, p, n);
+		line[n] = '\0';
+		p += n;
+		c->lines++;
+		c->status = parse_line(c, line);
+	}
+	free(line);
+	return (NULL);
+}
+
+/**
+ * parse_line - Decodes one line of a slice.
+ * @c: The slice.
+ * @line: The line, with its newline.
+ *
+ * Return: EXIT_SUCCESS, EXIT_FAILURE, or PARSE_RETRY on a line that
+ * load_program reports an error for.
+ */
+int parse_line(parse_chunk_t *c, char *line)
+{
+	int op, status;
+
+	op_toks = strtow(line, DELIMS);
+	if (op_toks == NULL && is_empty_line(line, DELIMS))
+		return (EXIT_SUCCESS);
+	if (op_toks == NULL)
+		return (PARSE_RETRY);
+	op = get_op_code(op_toks[0]);
+	if (op_toks[0][0] != '#' && op_toks[1] == NULL &&
+	    (strcmp(op_toks[0], "label") == 0 || op == OP_DEF ||
+	     (op != -1 && op_table[op].operand == OPND_LABEL)))
+		status = PARSE_RETRY;
+	else
+		status = decode_line(&c->prog, line, c->lines);
+	free_tokens();
+	return (status);
+}
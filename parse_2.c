@@ -0,0 +1,133 @@
+#include "monty.h"
+#include <string.h>
+
+int parse_stitch(parse_chunk_t *chunks, int n, prog_t *prog);
+int match_defs(prog_t *prog);
+
+/**
+ * parse_stitch - Joins the slices decoded by parse_parallel.
+ * @chunks: The slices, in script order.
+ * @n: Number of slices.
+ * @prog: The program to fill in.
+ *
+ * The slices' arrays are freed; their names and labels strings move to
+ * @prog. Pool offsets are shifted like names indexes and label targets.
+ *
+ * Return: EXIT_SUCCESS, EXIT_FAILURE after printing an error, or
+ * PARSE_RETRY if a slice did not decode.
+ */
+int parse_stitch(parse_chunk_t *chunks, int n, prog_t *prog)
+{
+	size_t code = 0, names = 0, labels = 0, pool = 0, lines = 0, base, i;
+	int k, kind, status = EXIT_SUCCESS;
+	prog_t *c;
+
+	memset(prog, 0, sizeof(*prog));
+	for (k = 0; k < n && status == EXIT_SUCCESS; k++)
+	{
+		status = chunks[k].status;
+		code += chunks[k].prog.len;
+		names += chunks[k].prog.n_names;
+		labels += chunks[k].prog.n_labels;
+		pool += chunks[k].prog.pool_len;
+	}
+	if (status == EXIT_SUCCESS)
+	{
+		prog->code = malloc(sizeof(instr_t) * (code + 1));
+		prog->names = malloc(sizeof(char *) * (names + 1));
+		prog->labels = malloc(sizeof(label_t) * (labels + 1));
+		prog->pool = malloc(sizeof(int) * (pool + 1));
+		if (!prog->code || !prog->names || !prog->labels ||
+		    !prog->pool)
+			status = malloc_error();
+	}
+	for (k = 0; k < n; k++)
+	{
+		c = &chunks[k].prog;
+		base = prog->len;
+		if (status != EXIT_SUCCESS)
+		{
+			free_program(c);
+			continue;
+		}
+		for (i = 0; i < c->len; i++)
+		{
+			prog->code[prog->len] = c->code[i];
+			prog->code[prog->len].line += lines;
+			kind = op_table[c->code[i].op].operand;
+			if (c->code[i].op == OP_BAD_OP || kind == OPND_LABEL ||
+			    kind == OPND_PATH)
+				prog->code[prog->len].arg += prog->n_names;
+			else if (kind == OPND_STRING || kind == OPND_LIST)
+				prog->code[prog->len].arg += prog->pool_len;
+			prog->len++;
+		}
+		for (i = 0; i < c->n_labels; i++)
+		{
+			prog->labels[prog->n_labels] = c->labels[i];
+			prog->labels[prog->n_labels].target += base;
+			prog->labels[prog->n_labels++].line += lines;
+		}
+		if (c->n_names > 0)
+			memcpy(prog->names + prog->n_names, c->names,
+			       sizeof(char *) * c->n_names);
+		prog->n_names += c->n_names;
+		if (c->pool_len > 0)
+			memcpy(prog->pool + prog->pool_len, c->pool,
+			       sizeof(int) * c->pool_len);
+		prog->pool_len += c->pool_len;
+		lines += chunks[k].lines;
+		free(c->code);
+		free(c->names);
+		free(c->labels);
+		free(c->pool);
+	}
+	prog->cap = prog->len;
+	prog->pool_cap = prog->pool_len;
+	prog->names_cap = prog->n_names;
+	prog->labels_cap = prog->n_labels;
+	if (status == EXIT_SUCCESS)
+		status = resolve_labels(prog);
+	return (status);
+}
+
+/**
+ * match_defs - Points each def at the instruction after its end.
+ * @prog: The loaded program, before its labels are sorted.
+ *
+ * Description: defs nest like brackets. While matching, the operand of
+ * an open def links to the def enclosing it, so no other stack is needed.
+ *
+ * Return: EXIT_SUCCESS, or EXIT_FAILURE on an end without def or a def
+ * without end.
+ */
+int match_defs(prog_t *prog)
+{
+	int open = -1, def;
+	size_t i;
+
+	for (i = 0; i < prog->len; i++)
+	{
+		if (prog->code[i].op == OP_DEF)
+		{
+			prog->code[i].arg = open;
+			open = i;
+		}
+		else if (prog->code[i].op == OP_END)
+		{
+			if (open == -1)
+				return (label_error(prog->code[i].line,
+						    "end without", "def"));
+			def = open;
+			open = prog->code[def].arg;
+			prog->code[def].arg = i + 1;
+		}
+	}
+	if (open == -1)
+		return (EXIT_SUCCESS);
+	for (i = 0; prog->labels[i].target != open + 1 ||
+		     prog->labels[i].line != prog->code[open].line; i++)
+		;
+	return (label_error(prog->code[open].line, "missing end for def",
+			    prog->labels[i].name));
+}
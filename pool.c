@@ -0,0 +1,141 @@
+#include "monty.h"
+#include <string.h>
+#include <limits.h>
+
+int pool_reserve(prog_t *prog, size_t n);
+int decode_pushs(prog_t *prog, char *line, unsigned int line_number);
+int decode_pushn(prog_t *prog, unsigned int line_number);
+int pool_escape(char **p);
+
+/**
+ * pool_reserve - Appends room for a literal to a program's pool.
+ * @prog: The program being loaded.
+ * @n: Number of values in the literal.
+ *
+ * Return: Offset of the literal, whose count is already stored, or -1
+ * after printing an error.
+ */
+int pool_reserve(prog_t *prog, size_t n)
+{
+	int *pool;
+	size_t cap = prog->pool_cap ? prog->pool_cap : 64;
+
+	if (n >= INT_MAX - prog->pool_len)
+	{
+		malloc_error();
+		return (-1);
+	}
+	while (cap < prog->pool_len + n + 1)
+		cap *= 2;
+	if (cap != prog->pool_cap)
+	{
+		pool = realloc(prog->pool, sizeof(int) * cap);
+		if (pool == NULL)
+		{
+			malloc_error();
+			return (-1);
+		}
+		prog->pool = pool;
+		prog->pool_cap = cap;
+	}
+	prog->pool[prog->pool_len] = n;
+	prog->pool_len += n + 1;
+	return (prog->pool_len - n - 1);
+}
+
+/**
+ * decode_pushs - Appends a pushs instruction and its string literal.
+ * @prog: The program being loaded.
+ * @line: The source line, which op_toks was split from; the literal is
+ * taken from it so that its spaces survive.
+ * @line_number: Line number of the instruction.
+ *
+ * The characters are pooled in order, so the first ends up on top and
+ * pstr prints the text. A malformed literal becomes OP_BAD_ARG.
+ *
+ * Return: EXIT_SUCCESS, or EXIT_FAILURE when the script cannot be loaded.
+ */
+int decode_pushs(prog_t *prog, char *line, unsigned int line_number)
+{
+	char *p = strstr(line, op_table[OP_PUSHS].opcode), *q;
+	int c, off;
+	size_t n = 0;
+
+	p += strlen(op_table[OP_PUSHS].opcode);
+	while (*p && strchr(DELIMS, *p))
+		p++;
+	if (*p++ != '"')
+		return (emit_instr(prog, OP_BAD_ARG, OP_PUSHS, line_number));
+	for (q = p; (c = pool_escape(&q)) >= 0; n++)
+		;
+	while (c == -1 && *q && strchr(DELIMS, *q))
+		q++;
+	if (c != -1 || *q)
+		return (emit_instr(prog, OP_BAD_ARG, OP_PUSHS, line_number));
+	off = pool_reserve(prog, n);
+	if (off == -1)
+		return (EXIT_FAILURE);
+	for (n = 1; (c = pool_escape(&p)) >= 0; n++)
+		prog->pool[off + n] = c;
+	return (emit_instr(prog, OP_PUSHS, off, line_number));
+}
+
+/**
+ * decode_pushn - Appends a pushn instruction and its integer literal.
+ * @prog: The program being loaded.
+ * @line_number: Line number of the instruction.
+ *
+ * The integers are pushed left to right, so the last one ends up on top.
+ * A missing or malformed integer becomes OP_BAD_ARG.
+ *
+ * Return: EXIT_SUCCESS, or EXIT_FAILURE when the script cannot be loaded.
+ */
+int decode_pushn(prog_t *prog, unsigned int line_number)
+{
+	size_t n, i;
+	int off;
+
+	for (n = 0; op_toks[n + 1] != NULL; n++)
+		if (!is_int_str(op_toks[n + 1]))
+			return (emit_instr(prog, OP_BAD_ARG, OP_PUSHN,
+					   line_number));
+	if (n == 0)
+		return (emit_instr(prog, OP_BAD_ARG, OP_PUSHN, line_number));
+	off = pool_reserve(prog, n);
+	if (off == -1)
+		return (EXIT_FAILURE);
+	for (i = 0; i < n; i++)
+		prog->pool[off + n - i] = atoi(op_toks[i + 1]);
+	return (emit_instr(prog, OP_PUSHN, off, line_number));
+}
+
+/**
+ * pool_escape - Reads the next character of a string literal.
+ * @p: Pointer into the literal, after its opening quote; advanced past
+ * the character.
+ *
+ * Description: \" and \\ stand for themselves, \n and \t for newline and
+ * tab.
+ *
+ * Return: The character, -1 at the closing quote, or -2 on a bad escape
+ * or a missing closing quote.
+ */
+int pool_escape(char **p)
+{
+	unsigned char c = *(*p)++;
+
+	if (c == '"')
+		return (-1);
+	if (c == '\0' || c == '\n')
+		return (-2);
+	if (c != '\\')
+		return (c);
+	c = *(*p)++;
+	if (c == '"' || c == '\\')
+		return (c);
+	if (c == 'n')
+		return ('\n');
+	if (c == 't')
+		return ('\t');
+	return (-2);
+}
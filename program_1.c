@@ -0,0 +1,212 @@
+#include "monty.h"
+#include <string.h>
+
+int is_empty_line(char *line, char *delims);
+int decode_line(prog_t *prog, char *line, unsigned int line_number);
+int load_program(FILE *script_fd, prog_t *prog);
+int emit_instr(prog_t *prog, int op, int arg, unsigned int line);
+int intern_name(prog_t *prog, char *name);
+
+/**
+ * is_empty_line - Detects lines with only delimiters from a getline input.
+ * @line: Pointer to the line.
+ * @delims: String of delimiter characters.
+ *
+ * Return: 1 if the line consists solely of delimiters, 0 otherwise.
+ */
+int is_empty_line(char *line, char *delims)
+{
+	lex_set_t set;
+
+	lex_init(&set, delims);
+	return (lex_scan(line, &set, NULL, 0) == 0);
+}
+
+/**
+ * decode_line - Appends the instruction held in op_toks to a program.
+ * @prog: The program being loaded.
+ * @line: The line op_toks was split from.
+ * @line_number: Line number of the tokens in the Monty bytecode file.
+ *
+ * Unknown opcodes and bad integer operands become OP_BAD_OP/OP_BAD_ARG
+ * instructions, so they are reported only if execution reaches them.
+ * "def NAME" becomes an OP_DEF followed by a label NAME on the body.
+ * The literals of pushs and pushn are decoded once, into the pool.
+ *
+ * Return: EXIT_SUCCESS, or EXIT_FAILURE when the script cannot be loaded.
+ */
+int decode_line(prog_t *prog, char *line, unsigned int line_number)
+{
+	int op, name;
+
+	if (op_toks[0][0] == '#') /* comment line */
+		return (EXIT_SUCCESS);
+	if (strcmp(op_toks[0], "label") == 0)
+		return (add_label(prog, op_toks[1], line_number));
+	if (strcmp(op_toks[0], "def") == 0)
+	{
+		if (op_toks[1] == NULL)
+			return (arg_error(line_number, "def", "name"));
+		if (emit_instr(prog, OP_DEF, 0, line_number) == EXIT_FAILURE)
+			return (EXIT_FAILURE);
+		return (add_label(prog, op_toks[1], line_number));
+	}
+
+	op = get_op_code(op_toks[0]);
+	if (op == -1)
+	{
+		name = intern_name(prog, op_toks[0]);
+		if (name == -1)
+			return (EXIT_FAILURE);
+		return (emit_instr(prog, OP_BAD_OP, name, line_number));
+	}
+	if (op_table[op].operand == OPND_INT ||
+	    op_table[op].operand == OPND_STACK ||
+	    op_table[op].operand == OPND_INDEX)
+	{
+		if (op_toks[1] == NULL || !is_int_str(op_toks[1]) ||
+		    (op_table[op].operand != OPND_INT &&
+		     atoi(op_toks[1]) < 0) ||
+		    (op_table[op].operand == OPND_STACK &&
+		     atoi(op_toks[1]) >= STACK_BANK))
+			return (emit_instr(prog, OP_BAD_ARG, op, line_number));
+		return (emit_instr(prog, op, atoi(op_toks[1]), line_number));
+	}
+	if (op_table[op].operand == OPND_PATH)
+	{
+		if (op_toks[1] == NULL)
+			return (emit_instr(prog, OP_BAD_ARG, op, line_number));
+		name = intern_name(prog, op_toks[1]);
+		if (name == -1)
+			return (EXIT_FAILURE);
+		return (emit_instr(prog, op, name, line_number));
+	}
+	if (op_table[op].operand == OPND_STRING)
+		return (decode_pushs(prog, line, line_number));
+	if (op_table[op].operand == OPND_LIST)
+		return (decode_pushn(prog, line_number));
+	if (op_table[op].operand == OPND_LABEL)
+	{
+		if (op_toks[1] == NULL)
+			return (arg_error(line_number, op_toks[0], "label"));
+		name = intern_name(prog, op_toks[1]);
+		if (name == -1)
+			return (EXIT_FAILURE);
+		return (emit_instr(prog, op, name, line_number));
+	}
+
+	return (emit_instr(prog, op, 0, line_number));
+}
+
+/**
+ * load_program - Decodes a whole Monty script into an instruction array.
+ * @script_fd: The script to read.
+ * @prog: The program to fill in; release it with free_program, even when
+ * loading fails.
+ *
+ * Jump targets are resolved to instruction indices once every line has
+ * been read. Large script files are decoded in parallel instead (see
+ * load_parallel).
+ *
+ * Return: EXIT_SUCCESS, or EXIT_FAILURE after printing an error.
+ */
+int load_program(FILE *script_fd, prog_t *prog)
+{
+	char *line = NULL;
+	size_t len = 0;
+	unsigned int line_number = 0;
+	int status;
+
+	status = load_parallel(script_fd, prog);
+	if (status != PARSE_RETRY)
+		return (status);
+	free_program(prog);
+	status = EXIT_SUCCESS;
+	while (getline(&line, &len, script_fd) != -1)
+	{
+		line_number++;
+		op_toks = strtow(line, DELIMS);
+		if (op_toks == NULL)
+		{
+			if (is_empty_line(line, DELIMS))
+				continue;
+			status = malloc_error();
+			break;
+		}
+		status = decode_line(prog, line, line_number);
+		free_tokens();
+		if (status != EXIT_SUCCESS)
+			break;
+	}
+
+	if (status == EXIT_SUCCESS)
+	{
+		prog->nul_tail = (line && *line == 0);
+		status = resolve_labels(prog);
+	}
+	free(line);
+	return (status);
+}
+
+/**
+ * emit_instr - Appends one instruction to a program.
+ * @prog: The program being loaded.
+ * @op: The OP_* opcode index.
+ * @arg: The instruction operand.
+ * @line: The source line number.
+ *
+ * Return: EXIT_SUCCESS, or EXIT_FAILURE if malloc fails.
+ */
+int emit_instr(prog_t *prog, int op, int arg, unsigned int line)
+{
+	instr_t *code;
+
+	if (prog->len == prog->cap)
+	{
+		code = realloc(prog->code, sizeof(instr_t) *
+			       (prog->cap ? prog->cap * 2 : 64));
+		if (code == NULL)
+			return (malloc_error());
+		prog->code = code;
+		prog->cap = prog->cap ? prog->cap * 2 : 64;
+	}
+	prog->code[prog->len].op = op;
+	prog->code[prog->len].arg = arg;
+	prog->code[prog->len].line = line;
+	prog->len++;
+
+	return (EXIT_SUCCESS);
+}
+
+/**
+ * intern_name - Stores a copy of a string referenced by an operand.
+ * @prog: The program being loaded.
+ * @name: The string to store.
+ *
+ * Return: The index of the copy in prog->names, or -1 if malloc fails.
+ */
+int intern_name(prog_t *prog, char *name)
+{
+	char **names;
+
+	if (prog->n_names == prog->names_cap)
+	{
+		names = realloc(prog->names, sizeof(char *) *
+				(prog->names_cap ? prog->names_cap * 2 : 16));
+		if (names == NULL)
+		{
+			malloc_error();
+			return (-1);
+		}
+		prog->names = names;
+		prog->names_cap = prog->names_cap ? prog->names_cap * 2 : 16;
+	}
+	prog->names[prog->n_names] = strdup(name);
+	if (prog->names[prog->n_names] == NULL)
+	{
+		malloc_error();
+		return (-1);
+	}
+
+	return (prog->n_names++);
+}
@@ -0,0 +1,164 @@
+#include "monty.h"
+#include <string.h>
+#include <sys/mman.h>
+
+int add_label(prog_t *prog, char *name, unsigned int line);
+int cmp_label(const void *a, const void *b);
+int resolve_labels(prog_t *prog);
+void free_program(prog_t *prog);
+int load_program_mem(char *src, size_t len, prog_t *prog);
+
+/**
+ * add_label - Records a label defining the next instruction index.
+ * @prog: The program being loaded.
+ * @name: The label name, or NULL if the line lacked one.
+ * @line: Line number of the definition.
+ *
+ * Return: EXIT_SUCCESS, or EXIT_FAILURE after printing an error.
+ */
+int add_label(prog_t *prog, char *name, unsigned int line)
+{
+	label_t *labels;
+	size_t cap;
+
+	if (name == NULL)
+		return (arg_error(line, "label", "name"));
+	if (prog->n_labels == prog->labels_cap)
+	{
+		cap = prog->labels_cap ? prog->labels_cap * 2 : 16;
+		labels = realloc(prog->labels, sizeof(label_t) * cap);
+		if (labels == NULL)
+			return (malloc_error());
+		prog->labels = labels;
+		prog->labels_cap = cap;
+	}
+	prog->labels[prog->n_labels].name = strdup(name);
+	if (prog->labels[prog->n_labels].name == NULL)
+		return (malloc_error());
+	prog->labels[prog->n_labels].target = prog->len;
+	prog->labels[prog->n_labels].line = line;
+	prog->n_labels++;
+
+	return (EXIT_SUCCESS);
+}
+
+/**
+ * cmp_label - qsort/bsearch comparator ordering labels by name.
+ * @a: Pointer to the first label_t.
+ * @b: Pointer to the second label_t.
+ *
+ * Return: Negative, zero or positive as strcmp.
+ */
+int cmp_label(const void *a, const void *b)
+{
+	return (strcmp(((const label_t *)a)->name, ((const label_t *)b)->name));
+}
+
+/**
+ * resolve_labels - Replaces label operands with instruction indices.
+ * @prog: The loaded program.
+ *
+ * Labels are sorted once and each jump is resolved with a binary search,
+ * so execution never looks at label names again. Each def is first
+ * matched with its end (see match_defs).
+ *
+ * Return: EXIT_SUCCESS, or EXIT_FAILURE on a duplicate or unknown label,
+ * or a def without end.
+ */
+int resolve_labels(prog_t *prog)
+{
+	label_t key, *found;
+	size_t i, line;
+
+	if (match_defs(prog) == EXIT_FAILURE)
+		return (EXIT_FAILURE);
+	if (prog->n_labels > 1)
+		qsort(prog->labels, prog->n_labels, sizeof(label_t), cmp_label);
+	for (i = 1; i < prog->n_labels; i++)
+	{
+		if (cmp_label(&prog->labels[i - 1], &prog->labels[i]) != 0)
+			continue;
+		line = prog->labels[i].line;
+		if (prog->labels[i - 1].line > line)
+			line = prog->labels[i - 1].line;
+		return (label_error(line, "duplicate label",
+				    prog->labels[i].name));
+	}
+	for (i = 0; i < prog->len; i++)
+	{
+		if (op_table[prog->code[i].op].operand != OPND_LABEL)
+			continue;
+		key.name = prog->names[prog->code[i].arg];
+		found = NULL;
+		if (prog->n_labels > 0)
+			found = bsearch(&key, prog->labels, prog->n_labels,
+					sizeof(label_t), cmp_label);
+		if (found == NULL)
+			return (label_error(prog->code[i].line, "unknown label",
+					    key.name));
+		prog->code[i].arg = found->target;
+	}
+
+	return (EXIT_SUCCESS);
+}
+
+/**
+ * free_program - Releases everything a loaded program owns.
+ * @prog: The program to release.
+ *
+ * A program mapped from the disk cache only owns its names array and the
+ * mapping itself.
+ */
+void free_program(prog_t *prog)
+{
+	size_t i;
+
+	if (prog->map != NULL)
+	{
+		free(prog->names);
+		munmap(prog->map, prog->map_len);
+		memset(prog, 0, sizeof(*prog));
+		return;
+	}
+	for (i = 0; i < prog->n_names; i++)
+		free(prog->names[i]);
+	for (i = 0; i < prog->n_labels; i++)
+		free(prog->labels[i].name);
+	free(prog->names);
+	free(prog->labels);
+	free(prog->pool);
+	free(prog->code);
+	memset(prog, 0, sizeof(*prog));
+}
+
+/**
+ * load_program_mem - Decodes a program held in memory.
+ * @src: The source, with one spare byte after it.
+ * @len: Length of the source.
+ * @prog: The program to fill in.
+ *
+ * Return: EXIT_SUCCESS, or EXIT_FAILURE on error.
+ */
+int load_program_mem(char *src, size_t len, prog_t *prog)
+{
+	FILE *stream;
+	int status;
+
+	if (len >= PARSE_MIN)
+	{
+		status = parse_parallel(src, len, prog);
+		if (status != PARSE_RETRY)
+			return (status);
+		free_program(prog);
+	}
+	src[len] = '\0';
+	stream = fmemopen(src, len ? len : 1, "r");
+	if (stream == NULL)
+	{
+		memset(prog, 0, sizeof(*prog));
+		return (malloc_error());
+	}
+	status = load_program(stream, prog);
+	fclose(stream);
+	return (status);
+}
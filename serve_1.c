@@ -0,0 +1,200 @@
+/* signal.h has its own stack_t (for sigaltstack); keep it out of the way */
+#define stack_t sig_stack_t
+#include <signal.h>
+#undef stack_t
+#include "monty.h"
+#include <string.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+int monty_serve(char *path);
+void serve_spawn(int listen_fd);
+void serve_worker(int listen_fd);
+void serve_job(serve_t *s, int c);
+void serve_alarm(int sig);
+
+/* job_conn - Connection of the job running, for serve_alarm */
+static int job_conn = -1;
+/* timeout_msg - The message of timeout_error, formatted ahead of time */
+static char timeout_msg[64];
+static int timeout_len;
+
+/**
+ * monty_serve - Runs the interpreter as a daemon on a Unix socket.
+ * @path: Path of the socket to listen on.
+ *
+ * Description: One worker process is forked per online CPU and all of
+ * them accept() on the same socket. Processes rather than threads because
+ * the VM keeps its state in globals (vm, op_toks); each worker keeps its
+ * own warm stack and program cache. The parent only respawns workers that
+ * die, so a script that crashes one never takes the daemon down.
+ * With --green the socket is non-blocking and each worker interleaves
+ * its jobs (see green_loop).
+ *
+ * Return: EXIT_FAILURE if the socket cannot be set up; never returns
+ * otherwise.
+ */
+int monty_serve(char *path)
+{
+	struct sockaddr_un addr;
+	struct stat st;
+	long workers, i;
+	int fd;
+
+	if (serve_socket(path, &addr) == EXIT_FAILURE)
+		return (EXIT_FAILURE);
+	if (lstat(path, &st) == 0 && S_ISSOCK(st.st_mode))
+		unlink(path);
+	fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd == -1 ||
+	    bind(fd, (struct sockaddr *)&addr, sizeof(addr)) == -1 ||
+	    listen(fd, 128) == -1)
+		return (sock_error(path));
+	if (opts.green && fcntl(fd, F_SETFL, O_NONBLOCK) == -1)
+		return (sock_error(path));
+	fflush(stdout);
+	workers = sysconf(_SC_NPROCESSORS_ONLN);
+	if (workers < 1)
+		workers = 1;
+	for (i = 0; i < workers; i++)
+		serve_spawn(fd);
+	while (1)
+	{
+		if (wait(NULL) != -1)
+			serve_spawn(fd);
+		else
+			sleep(1);
+	}
+}
+
+/**
+ * serve_spawn - Forks one daemon worker.
+ * @listen_fd: The listening socket.
+ */
+void serve_spawn(int listen_fd)
+{
+	if (fork() == 0)
+	{
+		serve_worker(listen_fd);
+		exit(EXIT_SUCCESS);
+	}
+}
+
+/**
+ * serve_worker - Accepts and runs jobs until the process is killed.
+ * @listen_fd: The listening socket.
+ */
+void serve_worker(int listen_fd)
+{
+	serve_t *s;
+	int c;
+
+	signal(SIGPIPE, SIG_IGN);
+	s = calloc(1, sizeof(*s));
+	if (s == NULL || init_stack(&s->stack) == EXIT_FAILURE)
+		exit(EXIT_FAILURE);
+	s->devnull = open("/dev/null", O_RDWR);
+	s->home = open(".", O_RDONLY | O_DIRECTORY);
+	if (s->devnull == -1 || s->home == -1)
+		exit(EXIT_FAILURE);
+	dup2(s->devnull, STDIN_FILENO);
+	dup2(s->devnull, STDOUT_FILENO);
+	dup2(s->devnull, STDERR_FILENO);
+	if (opts.green)
+		green_loop(s, listen_fd);
+	timeout_len = snprintf(timeout_msg, sizeof(timeout_msg),
+			       SERVE_TIMEOUT_MSG, opts.timeout);
+	signal(SIGALRM, serve_alarm);
+	while (1)
+	{
+		c = accept(listen_fd, NULL, NULL);
+		if (c == -1)
+			continue;
+		serve_job(s, c);
+		close(c);
+	}
+}
+
+/**
+ * serve_job - Runs one script sent by a client.
+ * @s: The worker state.
+ * @c: The connection to the client.
+ *
+ * Description: The client passes its own stdout, stderr and stdin, so
+ * output streams straight to it and read takes its input while the
+ * script runs; the exit status is sent back on the connection once the
+ * script is done. The script runs in the client's working directory, so
+ * load and save find the same files as a direct run, and is stopped
+ * after --timeout seconds (see serve_alarm).
+ */
+void serve_job(serve_t *s, int c)
+{
+	unsigned long len;
+	int fds[SERVE_FDS], i, status = EXIT_FAILURE;
+	char *src;
+	prog_t *prog;
+
+	if (serve_recv_hdr(c, &len, fds) == EXIT_FAILURE)
+		return;
+	src = malloc(len + 1);
+	if (src == NULL || read_full(c, src, len) == EXIT_FAILURE)
+	{
+		free(src);
+		for (i = 0; i < SERVE_FDS; i++)
+			close(fds[i]);
+		return;
+	}
+	dup2(fds[0], STDOUT_FILENO);
+	dup2(fds[1], STDERR_FILENO);
+	dup2(fds[2], STDIN_FILENO);
+	input_reset(vm.in, STDIN_FILENO, 0);
+	job_conn = c;
+	alarm(opts.timeout);
+	prog = NULL;
+	if (fchdir(fds[3]) == -1)
+	{
+		chdir_error();
+		free(src);
+	}
+	else
+		prog = serve_lookup(s, src, len);
+	for (i = 0; i < SERVE_FDS; i++)
+		close(fds[i]);
+	if (prog != NULL)
+	{
+		status = exec_program(prog, &s->stack);
+		if (status == EXIT_SUCCESS && prog->nul_tail)
+			status = malloc_error();
+		if (serve_reset(&s->stack) == EXIT_FAILURE)
+			exit(EXIT_FAILURE);
+	}
+	alarm(0);
+	fflush(stdout);
+	if (fchdir(s->home) == -1)
+		exit(EXIT_FAILURE);
+	dup2(s->devnull, STDOUT_FILENO);
+	dup2(s->devnull, STDERR_FILENO);
+	dup2(s->devnull, STDIN_FILENO);
+	write_full(c, &status, sizeof(status));
+}
+
+/**
+ * serve_alarm - Stops the job of a worker that ran past --timeout.
+ * @sig: SIGALRM.
+ *
+ * Description: The job may be anywhere, native code or a read waiting on
+ * the client, so the worker reports the timeout and the exit status with
+ * write and exits; monty_serve forks a fresh one. Output stdout still
+ * buffered is lost.
+ */
+void serve_alarm(int sig)
+{
+	int status = EXIT_FAILURE;
+
+	(void)sig;
+	write(STDERR_FILENO, timeout_msg, timeout_len);
+	write(job_conn, &status, sizeof(status));
+	_exit(EXIT_FAILURE);
+}
@@ -0,0 +1,139 @@
+#include "monty.h"
+#include <string.h>
+#include <sys/socket.h>
+
+prog_t *serve_lookup(serve_t *s, char *src, size_t len);
+cache_ent_t *serve_slot(serve_t *s, char *src, size_t len, int *hit);
+int serve_recv_hdr(int c, unsigned long *len, int *fds);
+int serve_reset(stack_t **stack);
+
+/**
+ * serve_lookup - Finds the decoded program for a source, decoding it on
+ * a cache miss.
+ * @s: The worker state.
+ * @src: The source, malloc'ed; the cache takes it over or frees it.
+ * @len: Length of the source.
+ *
+ * Return: The program, or NULL if it failed to load (the error has
+ * already been printed).
+ */
+prog_t *serve_lookup(serve_t *s, char *src, size_t len)
+{
+	cache_ent_t *ent;
+	prog_t prog;
+	int hit;
+
+	ent = serve_slot(s, src, len, &hit);
+	if (hit)
+	{
+		free(src);
+		return (&ent->prog);
+	}
+	if (load_program_mem(src, len, &prog) == EXIT_FAILURE)
+	{
+		free_program(&prog);
+		free(src);
+		return (NULL);
+	}
+	dce_trim(&prog);
+	if (ent->src != NULL)
+	{
+		free_program(&ent->prog);
+		free(ent->src);
+	}
+	ent->hash = hash_bytes(src, len);
+	ent->src = src;
+	ent->len = len;
+	ent->prog = prog;
+	return (&ent->prog);
+}
+
+/**
+ * serve_slot - Finds the cache entry a source maps to.
+ * @s: The worker state.
+ * @src: The source.
+ * @len: Length of the source.
+ * @hit: Set to non-zero if the entry holds the program of @src.
+ *
+ * Return: The entry.
+ */
+cache_ent_t *serve_slot(serve_t *s, char *src, size_t len, int *hit)
+{
+	unsigned long hash = hash_bytes(src, len);
+	cache_ent_t *ent = &s->cache[hash & (SERVE_CACHE - 1)];
+
+	*hit = ent->src != NULL && ent->hash == hash && ent->len == len &&
+		memcmp(ent->src, src, len) == 0;
+	return (ent);
+}
+
+/**
+ * serve_recv_hdr - Receives the header of a job.
+ * @c: The connection to the client.
+ * @len: Set to the length of the source that follows.
+ * @fds: Set to the client's stdout, stderr and stdin (SERVE_FDS).
+ *
+ * Return: EXIT_SUCCESS, or EXIT_FAILURE if the header is malformed.
+ */
+int serve_recv_hdr(int c, unsigned long *len, int *fds)
+{
+	struct msghdr msg;
+	struct iovec iov;
+	struct cmsghdr *cmsg;
+	char ctl[CMSG_SPACE(SERVE_FDS * sizeof(int))];
+	ssize_t n;
+	int i;
+
+	memset(&msg, 0, sizeof(msg));
+	iov.iov_base = len;
+	iov.iov_len = sizeof(*len);
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = ctl;
+	msg.msg_controllen = sizeof(ctl);
+	n = recvmsg(c, &msg, 0);
+	cmsg = CMSG_FIRSTHDR(&msg);
+	if (cmsg == NULL || cmsg->cmsg_type != SCM_RIGHTS ||
+	    cmsg->cmsg_len != CMSG_LEN(SERVE_FDS * sizeof(int)))
+		return (EXIT_FAILURE);
+	memcpy(fds, CMSG_DATA(cmsg), SERVE_FDS * sizeof(int));
+	if (n <= 0 || (n < (ssize_t)sizeof(*len) &&
+	    read_full(c, (char *)len + n, sizeof(*len) - n) == EXIT_FAILURE) ||
+	    *len > 0x7fffffffUL)
+	{
+		for (i = 0; i < SERVE_FDS; i++)
+			close(fds[i]);
+		return (EXIT_FAILURE);
+	}
+	return (EXIT_SUCCESS);
+}
+
+/**
+ * serve_reset - Empties a worker's stacks for the next job.
+ * @stack: The selected stack_t of the bank; set to the first one.
+ *
+ * The ring buffers are kept so the next job starts with warm memory,
+ * unless a script grew one past SERVE_ARENA_MAX. The map is dropped.
+ *
+ * Return: EXIT_SUCCESS, or EXIT_FAILURE if malloc fails.
+ */
+int serve_reset(stack_t **stack)
+{
+	stack_t *bank = *stack - (*stack)->id;
+	int i;
+
+	*stack = bank;
+	map_free(&bank->map);
+	for (i = 0; i < STACK_BANK; i++)
+	{
+		if (bank[i].cap > SERVE_ARENA_MAX)
+		{
+			free_stack(stack);
+			return (init_stack(stack));
+		}
+		bank[i].head = 0;
+		bank[i].len = 0;
+		bank[i].mode = STACK;
+	}
+	return (EXIT_SUCCESS);
+}
@@ -0,0 +1,113 @@
+#include "monty.h"
+#include <string.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+
+int serve_socket(char *path, struct sockaddr_un *addr);
+int submit_send_hdr(int c, unsigned long len, int dir);
+int monty_submit(char *path, char *file);
+
+/**
+ * serve_socket - Fills in the address of a Unix socket.
+ * @path: The socket path.
+ * @addr: The address to fill in.
+ *
+ * Return: EXIT_SUCCESS, or EXIT_FAILURE if the path is too long.
+ */
+int serve_socket(char *path, struct sockaddr_un *addr)
+{
+	memset(addr, 0, sizeof(*addr));
+	addr->sun_family = AF_UNIX;
+	if (strlen(path) >= sizeof(addr->sun_path))
+		return (sock_error(path));
+	strcpy(addr->sun_path, path);
+	return (EXIT_SUCCESS);
+}
+
+/**
+ * submit_send_hdr - Sends the header of a job, passing stdout, stderr,
+ * stdin and the working directory.
+ * @c: The connection to the daemon.
+ * @len: Length of the source that follows.
+ * @dir: Descriptor of the working directory.
+ *
+ * Return: EXIT_SUCCESS, or EXIT_FAILURE on error.
+ */
+int submit_send_hdr(int c, unsigned long len, int dir)
+{
+	struct msghdr msg;
+	struct iovec iov;
+	struct cmsghdr *cmsg;
+	char ctl[CMSG_SPACE(SERVE_FDS * sizeof(int))];
+	int fds[SERVE_FDS];
+
+	fds[0] = STDOUT_FILENO;
+	fds[1] = STDERR_FILENO;
+	fds[2] = STDIN_FILENO;
+	fds[3] = dir;
+	memset(&msg, 0, sizeof(msg));
+	memset(ctl, 0, sizeof(ctl));
+	iov.iov_base = &len;
+	iov.iov_len = sizeof(len);
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = ctl;
+	msg.msg_controllen = sizeof(ctl);
+	cmsg = CMSG_FIRSTHDR(&msg);
+	cmsg->cmsg_level = SOL_SOCKET;
+	cmsg->cmsg_type = SCM_RIGHTS;
+	cmsg->cmsg_len = CMSG_LEN(sizeof(fds));
+	memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+	if (sendmsg(c, &msg, 0) != (ssize_t)sizeof(len))
+		return (EXIT_FAILURE);
+	return (EXIT_SUCCESS);
+}
+
+/**
+ * monty_submit - Runs a script on a daemon started with --serve.
+ * @path: The daemon's socket path.
+ * @file: The script.
+ *
+ * Return: The exit status of the script, or EXIT_FAILURE on error.
+ */
+int monty_submit(char *path, char *file)
+{
+	struct sockaddr_un addr;
+	FILE *script_fd;
+	char *src;
+	size_t len;
+	int c, dir, status;
+
+	script_fd = fopen(file, "r");
+	if (script_fd == NULL)
+		return (f_open_error(file));
+	src = read_stream(script_fd, &len);
+	fclose(script_fd);
+	if (src == NULL)
+		return (malloc_error());
+	dir = open(".", O_RDONLY | O_DIRECTORY);
+	if (dir == -1)
+	{
+		free(src);
+		return (f_open_error("."));
+	}
+	if (serve_socket(path, &addr) == EXIT_FAILURE)
+	{
+		free(src);
+		close(dir);
+		return (EXIT_FAILURE);
+	}
+	fflush(stdout);
+	c = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (c == -1 ||
+	    connect(c, (struct sockaddr *)&addr, sizeof(addr)) == -1 ||
+	    submit_send_hdr(c, len, dir) == EXIT_FAILURE ||
+	    write_full(c, src, len) == EXIT_FAILURE ||
+	    read_full(c, &status, sizeof(status)) == EXIT_FAILURE)
+		status = sock_error(path);
+	free(src);
+	close(dir);
+	if (c != -1)
+		close(c);
+	return (status);
+}
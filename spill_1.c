@@ -0,0 +1,139 @@
+#include "monty.h"
+#include <string.h>
+
+int spill_run(prog_t *prog, stack_t **stack);
+int spill_fill(stack_t *stack);
+int spill_out(stack_t *stack);
+int spill_push(stack_t *stack, int n);
+int spill_pop(stack_t *stack, int *n);
+
+/**
+ * spill_run - Executes a program with --spill.
+ * @prog: The decoded program.
+ * @stack: The stack_t the program operates on.
+ *
+ * Description: Stacks that outgrow --max-memory page the bottom half of
+ * their ring buffer out to a temporary file (see stack_room). After each
+ * instruction, the stacks it popped get values back from the file if
+ * their ring buffer ran low, so opcodes only ever see the ring buffer;
+ * those that reach deeper call spill_reach first.
+ *
+ * Return: EXIT_SUCCESS, or the exit code of the first opcode that failed.
+ */
+int spill_run(prog_t *prog, stack_t **stack)
+{
+	instr_t *in;
+	int status;
+
+	vm.prog = prog;
+	vm.ip = 0;
+	vm.rsp = 0;
+	vm.status = EXIT_SUCCESS;
+	while (vm.ip < prog->len && vm.status == EXIT_SUCCESS)
+	{
+		in = &prog->code[vm.ip++];
+		vm.arg = in->arg;
+		op_table[in->op].f(stack, in->line);
+		status = spill_fill(*stack);
+		if (status == EXIT_SUCCESS && in->op == OP_MOVFROM)
+			status = spill_fill(*stack - (*stack)->id + in->arg);
+		if (status != EXIT_SUCCESS && vm.status == EXIT_SUCCESS)
+			set_op_error(limit_error(status, in->line,
+						 op_table[in->op].opcode));
+	}
+	return (vm.status);
+}
+
+/**
+ * spill_fill - Refills a spilled stack_t whose ring buffer ran low.
+ * @stack: The stack_t.
+ *
+ * Return: EXIT_SUCCESS, or the failure of spill_reach.
+ */
+int spill_fill(stack_t *stack)
+{
+	return (spill_reach(stack, SPILL_KEEP - 1));
+}
+
+/**
+ * spill_out - Pages the bottom half of a full ring buffer out.
+ * @stack: The stack_t, whose @cap is a multiple of 2 * SPILL_CHUNK.
+ *
+ * The chunks go above those already in the file, since they were
+ * closer to the top.
+ *
+ * Return: EXIT_SUCCESS, or the failure of spill_new or spill_store.
+ */
+int spill_out(stack_t *stack)
+{
+	size_t low = stack->len / 2, start, i, n = SPILL_CHUNK;
+	spill_t *sp;
+	int status;
+
+	if (stack->spill == NULL && spill_new(stack) != EXIT_SUCCESS)
+		return (STACK_IO);
+	sp = stack->spill;
+	for (start = stack->len - n; start >= low; start -= n)
+	{
+		for (i = 0; i < n; i++)
+			sp->buf[i] = STACK_AT(stack, start + i);
+		status = spill_store(sp, sp->buf, n, 1);
+		if (status != EXIT_SUCCESS)
+			return (status);
+		stack->len -= n;
+		sp->len += n;
+	}
+	return (EXIT_SUCCESS);
+}
+
+/**
+ * spill_push - Adds a value below the bottom of a spilled stack_t.
+ * @stack: The stack_t, with values in its spill.
+ * @n: The value.
+ *
+ * Return: EXIT_SUCCESS, or the failure of spill_store.
+ */
+int spill_push(stack_t *stack, int n)
+{
+	spill_t *sp = stack->spill;
+	int status;
+
+	if (sp->tail_len == SPILL_CHUNK)
+	{
+		status = spill_store(sp, sp->tail, SPILL_CHUNK, 0);
+		if (status != EXIT_SUCCESS)
+			return (status);
+		sp->tail_len = 0;
+	}
+	sp->tail[sp->tail_len++] = n;
+	sp->len++;
+	return (EXIT_SUCCESS);
+}
+
+/**
+ * spill_pop - Removes the bottom value of a stack_t.
+ * @stack: The stack_t, not empty.
+ * @n: Where to store the value.
+ *
+ * Return: EXIT_SUCCESS, or the failure of spill_take.
+ */
+int spill_pop(stack_t *stack, int *n)
+{
+	spill_t *sp = stack->spill;
+	int status;
+
+	if (sp == NULL || sp->len == 0)
+	{
+		*n = STACK_AT(stack, --stack->len);
+		return (EXIT_SUCCESS);
+	}
+	if (sp->tail_len == 0)
+	{
+		status = spill_take(sp, 0, sp->tail, &sp->tail_len);
+		if (status != EXIT_SUCCESS)
+			return (status);
+	}
+	*n = sp->tail[--sp->tail_len];
+	sp->len--;
+	return (EXIT_SUCCESS);
+}
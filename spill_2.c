@@ -0,0 +1,156 @@
+#include "monty.h"
+#include <string.h>
+
+int spill_rotate(stack_t *stack, long k);
+int spill_print(stack_t *stack, int str);
+int spill_print_vals(int *vals, size_t len, int str);
+int spill_new(stack_t *stack);
+void spill_free(stack_t *stack);
+
+/**
+ * spill_rotate - Rotates a spilled stack_t towards its top by k positions.
+ * @stack: The stack_t, with values in its spill.
+ * @k: Number of positions, as for stack_rotate.
+ *
+ * Values are moved one at a time between the top of the ring buffer and
+ * the bottom of the spill, in whichever direction is shorter.
+ *
+ * Return: EXIT_SUCCESS, or the failure of the spill operations.
+ */
+int spill_rotate(stack_t *stack, long k)
+{
+	size_t depth = STACK_DEPTH(stack), mask = stack->cap - 1, steps;
+	int n, status = EXIT_SUCCESS;
+
+	k %= (long)depth;
+	if (k < 0)
+		k += depth;
+	if ((size_t)k <= depth / 2)
+		for (steps = k; steps > 0 && !status; steps--)
+		{
+			n = STACK_AT(stack, 0);
+			stack->head = (stack->head + 1) & mask;
+			stack->len--;
+			status = spill_push(stack, n);
+			if (status == EXIT_SUCCESS)
+				status = spill_fill(stack);
+		}
+	else
+		for (steps = depth - k; steps > 0 && !status; steps--)
+		{
+			status = spill_pop(stack, &n);
+			if (status == EXIT_SUCCESS && stack->len == stack->cap)
+				status = stack_room(stack);
+			if (status == EXIT_SUCCESS)
+			{
+				mask = stack->cap - 1;
+				stack->head = (stack->head - 1) & mask;
+				stack->vals[stack->head] = n;
+				stack->len++;
+			}
+		}
+	return (status);
+}
+
+/**
+ * spill_print - Prints a spilled stack_t from top to bottom.
+ * @stack: The stack_t.
+ * @str: 0 to print one number per line as pall does, 1 to print
+ * characters up to the first non-ASCII value as pstr does.
+ *
+ * Return: EXIT_SUCCESS, or STACK_IO if the spill file can't be read.
+ */
+int spill_print(stack_t *stack, int str)
+{
+	spill_t *sp = stack->spill;
+	size_t i, n, first = stack->cap - stack->head;
+
+	if (first > stack->len)
+		first = stack->len;
+	if (spill_print_vals(stack->vals + stack->head, first, str) ||
+	    spill_print_vals(stack->vals, stack->len - first, str))
+		return (EXIT_SUCCESS);
+	for (i = 0; i < sp->n_chunks; i++)
+	{
+		n = sp->chunks[i].len;
+		if (spill_read(sp, i, sp->buf) != EXIT_SUCCESS)
+			return (STACK_IO);
+		if (spill_print_vals(sp->buf, n, str))
+			return (EXIT_SUCCESS);
+	}
+	spill_print_vals(sp->tail, sp->tail_len, str);
+	return (EXIT_SUCCESS);
+}
+
+/**
+ * spill_print_vals - Prints values for spill_print.
+ * @vals: The values, top first.
+ * @len: Number of values.
+ * @str: As for spill_print.
+ *
+ * Return: 1 if pstr stopped at one of the values, else 0.
+ */
+int spill_print_vals(int *vals, size_t len, int str)
+{
+	size_t i;
+
+	for (i = 0; i < len; i++)
+	{
+		if (!str)
+			printf("%d\n", vals[i]);
+		else if (vals[i] <= 0 || vals[i] > 127)
+			return (1);
+		else
+			putchar(vals[i]);
+	}
+	return (0);
+}
+
+/**
+ * spill_new - Gives a stack_t an empty spill.
+ * @stack: The stack_t.
+ *
+ * Return: EXIT_SUCCESS, or EXIT_FAILURE if the temporary file or the
+ * buffers can't be allocated.
+ */
+int spill_new(stack_t *stack)
+{
+	spill_t *sp = calloc(1, sizeof(spill_t));
+
+	if (sp == NULL)
+		return (EXIT_FAILURE);
+	stack->spill = sp;
+	sp->file = tmpfile();
+	sp->tail = malloc(sizeof(int) * SPILL_CHUNK);
+	sp->buf = malloc(sizeof(int) * SPILL_CHUNK);
+	if (sp->tail != NULL && sp->buf != NULL)
+		vm.mem += 2 * sizeof(int) * SPILL_CHUNK;
+	if (sp->file == NULL || sp->tail == NULL || sp->buf == NULL)
+	{
+		spill_free(stack);
+		return (EXIT_FAILURE);
+	}
+	return (EXIT_SUCCESS);
+}
+
+/**
+ * spill_free - Releases the spill of a stack_t, if it has one.
+ * @stack: The stack_t.
+ */
+void spill_free(stack_t *stack)
+{
+	spill_t *sp = stack->spill;
+
+	if (sp == NULL)
+		return;
+	if (sp->file != NULL)
+		fclose(sp->file);
+	if (sp->tail != NULL && sp->buf != NULL)
+		vm.mem -= 2 * sizeof(int) * SPILL_CHUNK;
+	free(sp->chunks);
+	free(sp->free);
+	free(sp->tail);
+	free(sp->buf);
+	free(sp);
+	stack->spill = NULL;
+}
@@ -0,0 +1,176 @@
+#include "monty.h"
+#include <string.h>
+
+int spill_store(spill_t *sp, int *vals, size_t len, int front);
+int spill_read(spill_t *sp, size_t i, int *vals);
+int spill_take(spill_t *sp, int front, int *vals, size_t *len);
+int spill_reach(stack_t *stack, size_t depth);
+int spill_peek(stack_t *stack, size_t depth, int *n);
+
+/**
+ * spill_store - Writes a chunk to a spill file.
+ * @sp: The spill.
+ * @vals: The values, top first.
+ * @len: Number of values, at most SPILL_CHUNK.
+ * @front: 1 to put the chunk above the others, 0 below them.
+ *
+ * Return: EXIT_SUCCESS, EXIT_FAILURE if malloc fails, or STACK_IO if the
+ * file can't be written.
+ */
+int spill_store(spill_t *sp, int *vals, size_t len, int front)
+{
+	spill_chunk_t *chunks;
+	size_t *free_slots, slot, cap;
+
+	cap = sp->chunks_cap ? sp->chunks_cap * 2 : 16;
+	if (sp->n_chunks == sp->chunks_cap)
+	{
+		chunks = realloc(sp->chunks, sizeof(spill_chunk_t) * cap);
+		if (chunks != NULL)
+			sp->chunks = chunks;
+		free_slots = realloc(sp->free, sizeof(size_t) * cap);
+		if (free_slots != NULL)
+			sp->free = free_slots;
+		if (chunks == NULL || free_slots == NULL)
+			return (EXIT_FAILURE);
+		sp->chunks_cap = cap;
+	}
+	slot = sp->n_free > 0 ? sp->free[--sp->n_free] : sp->n_slots++;
+	if (pwrite(fileno(sp->file), vals, sizeof(int) * len,
+		   (off_t)(slot * SPILL_CHUNK * sizeof(int))) !=
+	    (ssize_t)(sizeof(int) * len))
+	{
+		sp->free[sp->n_free++] = slot;
+		return (STACK_IO);
+	}
+	if (front)
+	{
+		memmove(sp->chunks + 1, sp->chunks,
+			sizeof(spill_chunk_t) * sp->n_chunks);
+		sp->chunks[0].slot = slot;
+		sp->chunks[0].len = len;
+	}
+	else
+	{
+		sp->chunks[sp->n_chunks].slot = slot;
+		sp->chunks[sp->n_chunks].len = len;
+	}
+	sp->n_chunks++;
+	return (EXIT_SUCCESS);
+}
+
+/**
+ * spill_read - Reads a chunk of a spill file.
+ * @sp: The spill.
+ * @i: Index of the chunk, from the top.
+ * @vals: Where to store its values, SPILL_CHUNK long.
+ *
+ * Return: EXIT_SUCCESS, or STACK_IO if the file can't be read.
+ */
+int spill_read(spill_t *sp, size_t i, int *vals)
+{
+	size_t size = sizeof(int) * sp->chunks[i].len;
+
+	if (pread(fileno(sp->file), vals, size,
+		  (off_t)(sp->chunks[i].slot * SPILL_CHUNK * sizeof(int))) !=
+	    (ssize_t)size)
+		return (STACK_IO);
+	return (EXIT_SUCCESS);
+}
+
+/**
+ * spill_take - Reads the top or bottom chunk of a spill file and drops it.
+ * @sp: The spill, with at least one chunk.
+ * @front: 1 for the top chunk, 0 for the bottom one.
+ * @vals: Where to store its values, SPILL_CHUNK long.
+ * @len: Where to store the number of values.
+ *
+ * Return: EXIT_SUCCESS, or STACK_IO if the file can't be read.
+ */
+int spill_take(spill_t *sp, int front, int *vals, size_t *len)
+{
+	size_t i = front ? 0 : sp->n_chunks - 1;
+
+	if (spill_read(sp, i, vals) != EXIT_SUCCESS)
+		return (STACK_IO);
+	*len = sp->chunks[i].len;
+	sp->free[sp->n_free++] = sp->chunks[i].slot;
+	sp->n_chunks--;
+	if (front)
+		memmove(sp->chunks, sp->chunks + 1,
+			sizeof(spill_chunk_t) * sp->n_chunks);
+	return (EXIT_SUCCESS);
+}
+
+/**
+ * spill_reach - Moves spilled values back into the ring buffer until it
+ * holds the value @depth places below the top.
+ * @stack: The stack_t.
+ * @depth: The depth; the spill may run out first.
+ *
+ * Values come back a chunk at a time, nearest to the top first.
+ *
+ * Return: EXIT_SUCCESS, or the failure of spill_take or stack_grow.
+ */
+int spill_reach(stack_t *stack, size_t depth)
+{
+	spill_t *sp = stack->spill;
+	size_t n, i;
+	int status;
+
+	while (sp && sp->len > 0 && stack->len <= depth)
+	{
+		if (sp->n_chunks > 0)
+		{
+			status = spill_take(sp, 1, sp->buf, &n);
+			if (status != EXIT_SUCCESS)
+				return (status);
+		}
+		else
+		{
+			n = sp->tail_len;
+			memcpy(sp->buf, sp->tail, sizeof(int) * n);
+			sp->tail_len = 0;
+		}
+		while (stack->cap - stack->len < n)
+		{
+			status = stack_grow(stack);
+			if (status != EXIT_SUCCESS)
+				return (status);
+		}
+		for (i = 0; i < n; i++)
+			STACK_AT(stack, stack->len + i) = sp->buf[i];
+		stack->len += n;
+		sp->len -= n;
+	}
+	return (EXIT_SUCCESS);
+}
+
+/**
+ * spill_peek - Reads one spilled value without moving any back.
+ * @stack: The stack_t.
+ * @depth: Places below the top, at least the ring buffer's length and
+ * less than STACK_DEPTH.
+ * @n: Where to store the value.
+ *
+ * Return: EXIT_SUCCESS, or STACK_IO if the file can't be read.
+ */
+int spill_peek(stack_t *stack, size_t depth, int *n)
+{
+	spill_t *sp = stack->spill;
+	size_t i, j = depth - stack->len;
+	off_t pos;
+
+	for (i = 0; i < sp->n_chunks && j >= sp->chunks[i].len; i++)
+		j -= sp->chunks[i].len;
+	if (i == sp->n_chunks)
+	{
+		*n = sp->tail[j];
+		return (EXIT_SUCCESS);
+	}
+	pos = (off_t)((sp->chunks[i].slot * SPILL_CHUNK + j) * sizeof(int));
+	if (pread(fileno(sp->file), n, sizeof(int), pos) !=
+	    (ssize_t)sizeof(int))
+		return (STACK_IO);
+	return (EXIT_SUCCESS);
+}
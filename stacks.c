@@ -8,41 +8,63 @@ int check_mode(stack_t *stack);
 /**
  * free_stack - Deallocates memory used by a stack_t structure.
  *
- * This function releases the memory allocated for a stack_t structure.
- * It takes a pointer to the top (for stacks) or bottom (for queues) of
- * a stack_t and frees the associated memory, preventing memory leaks.
+ * This function releases the whole bank the stack_t belongs to: every
+ * ring buffer, the map and the headers, whichever stack is selected, and
+ * resets the caller's pointer to NULL.
  *
- * @stack: A pointer to the top (stack) or bottom (queue) of a stack_t.
+ * @stack: A pointer to the stack_t to release.
  */
 void free_stack(stack_t **stack)
 {
-	stack_t *tmp = *stack;
+	stack_t *bank;
+	int i;
 
-	while (*stack)
+	if (*stack == NULL)
+		return;
+
+	bank = *stack - (*stack)->id;
+	map_free(&bank->map);
+	for (i = 0; i < STACK_BANK; i++)
 	{
-		tmp = (*stack)->next;
-		free(*stack);
-		*stack = tmp;
+		spill_free(&bank[i]);
+		vm.mem -= sizeof(int) * bank[i].cap;
+		free(bank[i].vals);
 	}
+	free(bank);
+	*stack = NULL;
 }
 
 /**
- * init_stack - Sets up a stack_t with start and end nodes.
- * @stack: Pointer to an uninit. stack_t.
+ * init_stack - Sets up a bank of empty stack_t in STACK mode.
+ * @stack: Pointer to an uninit. stack_t; set to the first of the bank.
+ *
+ * The STACK_BANK headers share one allocation, so select only moves the
+ * pointer.
  *
  * Return: EXIT_FAILURE on error, else EXIT_SUCCESS.
  */
 int init_stack(stack_t **stack)
 {
 	stack_t *s;
+	int i;
 
-	s = malloc(sizeof(stack_t));
+	s = calloc(STACK_BANK, sizeof(stack_t));
 	if (s == NULL)
 		return (malloc_error());
 
-	s->n = STACK;
-	s->prev = NULL;
-	s->next = NULL;
+	for (i = 0; i < STACK_BANK; i++)
+	{
+		s[i].vals = malloc(sizeof(int) * STACK_INIT_CAP);
+		if (s[i].vals == NULL)
+		{
+			free_stack(&s);
+			return (malloc_error());
+		}
+		s[i].cap = STACK_INIT_CAP;
+		s[i].mode = STACK;
+		s[i].id = i;
+		vm.mem += sizeof(int) * STACK_INIT_CAP;
+	}
 
 	*stack = s;
 
@@ -50,13 +72,9 @@ int init_stack(stack_t **stack)
 }
 
 /**
- * check_mode - Analyzes the operational mode of a stack_t linked list.
- *
- * This function examines a given stack_t linked list to determine whether it
- * behaves as a stack or a queue. It assesses the order of elements and
- * provides a clear indication of the list's operational mode.
+ * check_mode - Analyzes the operational mode of a stack_t.
  *
- * @stack: A pointer to the head of the stack_t linked list to be analyzed.
+ * @stack: A pointer to the stack_t to be analyzed.
  *
  * Return:
  *   - STACK (0) if the list operates as a stack.
@@ -65,9 +83,9 @@ int init_stack(stack_t **stack)
  */
 int check_mode(stack_t *stack)
 {
-	if (stack->n == STACK)
+	if (stack->mode == STACK)
 		return (STACK);
-	else if (stack->n == QUEUE)
+	else if (stack->mode == QUEUE)
 		return (QUEUE);
 	return (2);
 }
@@ -0,0 +1,16 @@
+# subroutines: double the top value, then print it
+def double
+push 2
+mul
+end
+def show
+pint
+ret
+end
+push 3
+call double
+call show
+call double
+call show
+pop
+pall
@@ -0,0 +1,5 @@
+# movfrom the current stack: the second pop still fails
+push 1
+movfrom 0
+pop
+pop
@@ -0,0 +1,6 @@
+# movto back onto the current stack: the div still fails
+push 1
+push 5
+push 0
+movto 0
+div
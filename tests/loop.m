@@ -0,0 +1,15 @@
+push 0
+push 10
+label again
+swap
+push 1
+add
+swap
+loop again
+pint
+jz done
+push 72
+pchar
+label done
+pop
+pall
@@ -0,0 +1,23 @@
+# associative storage: store, fetch, has and del
+push 100
+push 1
+store
+push 200
+push 2
+store
+push 2
+fetch
+pall
+pop
+push 1
+has
+push 3
+has
+pall
+pop
+pop
+push 1
+del
+push 1
+has
+pint
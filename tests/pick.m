@@ -0,0 +1,16 @@
+# indexed access: copy and move values from below the top
+push 1
+push 2
+push 3
+dup
+over
+pall
+pick 4
+roll 3
+pall
+drop 4
+pall
+queue
+pick 1
+roll 2
+pall
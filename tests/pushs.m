@@ -0,0 +1,10 @@
+# literals: a string prints back with pstr, a list keeps its order
+pushs "Hello,\tWorld!\n"
+pstr
+pushs "say \"hi\""
+pstr
+pushn 1 2 3
+pall
+queue
+pushn 4 5
+pall
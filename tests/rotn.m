@@ -0,0 +1,13 @@
+push 1
+push 2
+push 3
+push 4
+push 5
+rotn 2
+pall
+rotn -3
+pall
+queue
+push 6
+rotn 1
+pall
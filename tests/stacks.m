@@ -0,0 +1,14 @@
+push 1
+push 2
+push 3
+movto 1
+movto 1
+select 1
+pall
+queue
+movfrom 0
+pall
+select 0
+pall
+movfrom 1
+pall
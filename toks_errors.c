@@ -1,37 +1,48 @@
 #include "monty.h"
 
+void set_op_error(int error_code);
+void monty_bad_op(stack_t **stack, unsigned int line_number);
+void monty_bad_arg(stack_t **stack, unsigned int line_number);
+
 /**
- * set_op_tok_error - Augments op_toks with an error code entry.
- * @error_code: Integer to transform into a string and append to op_toks.
+ * set_op_error - Records the exit code of a failing opcode.
+ * @error_code: The code returned by the error reporting function.
+ *
+ * exec_program stops at the first instruction that sets an error.
  */
 
-void set_op_tok_error(int error_code)
+void set_op_error(int error_code)
+{
+	vm.status = error_code;
+}
+
+/**
+ * monty_bad_op - Stands in for a line whose opcode is unknown.
+ * @stack: The stack_t of the running program (unused).
+ * @line_number: Line number of the unknown opcode.
+ *
+ * The opcode text is kept in the program's names, indexed by the operand.
+ */
+void monty_bad_op(stack_t **stack, unsigned int line_number)
 {
-	int toks_len = 0, i = 0;
-	char *exit_str = NULL;
-	char **new_toks = NULL;
+	set_op_error(unknown_op_error(vm.prog->names[vm.arg], line_number));
+	(void)stack;
+}
 
-	toks_len = token_arr_len();
-	new_toks = malloc(sizeof(char *) * (toks_len + 2));
-	if (!op_toks)
-	{
-		malloc_error();
-		return;
-	}
-	while (i < toks_len)
-	{
-		new_toks[i] = op_toks[i];
-		i++;
-	}
-	exit_str = get_int(error_code);
-	if (!exit_str)
-	{
-		free(new_toks);
-		malloc_error();
-		return;
-	}
-	new_toks[i++] = exit_str;
-	new_toks[i] = NULL;
-	free(op_toks);
-	op_toks = new_toks;
+/**
+ * monty_bad_arg - Stands in for a line whose integer operand is missing
+ *                 or malformed.
+ * @stack: The stack_t of the running program (unused).
+ * @line_number: Line number of the bad operand.
+ *
+ * The operand holds the OP_* index of the opcode that was given it.
+ */
+void monty_bad_arg(stack_t **stack, unsigned int line_number)
+{
+	if (vm.arg == OP_PUSH)
+		set_op_error(no_int_error(line_number));
+	else
+		set_op_error(arg_error(line_number, op_table[vm.arg].opcode,
+				       OPND_USAGE(vm.arg)));
+	(void)stack;
 }
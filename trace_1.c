@@ -0,0 +1,103 @@
+#include "monty.h"
+#include <string.h>
+
+int trace_run(prog_t *prog, stack_t **stack);
+void trace_record(trace_t *t, instr_t *in, long before, stack_t *after);
+void trace_flush(trace_t *t);
+
+/**
+ * trace_run - Runs a program, recording every instruction it executes.
+ * @prog: The decoded program.
+ * @stack: The stack_t the program operates on.
+ *
+ * Description: The VM only encodes records into the ring; a background
+ * thread writes full blocks to the --trace file, so tracing costs a few
+ * bytes of encoding per instruction rather than a write.
+ *
+ * Return: EXIT_SUCCESS, or the exit code of the first opcode that failed
+ * (or EXIT_FAILURE if the trace could not be written).
+ */
+int trace_run(prog_t *prog, stack_t **stack)
+{
+	trace_t t;
+	instr_t *in;
+	long before;
+
+	if (trace_open(&t, opts.trace) == EXIT_FAILURE)
+		return (EXIT_FAILURE);
+	vm.prog = prog;
+	vm.ip = 0;
+	vm.rsp = 0;
+	vm.status = EXIT_SUCCESS;
+	while (vm.ip < prog->len && vm.status == EXIT_SUCCESS)
+	{
+		in = &prog->code[vm.ip++];
+		vm.arg = in->arg;
+		before = (*stack)->len ? STACK_AT(*stack, 0) : TRACE_NONE;
+		op_table[in->op].f(stack, in->line);
+		trace_record(&t, in, before, *stack);
+	}
+	if (trace_close(&t) == EXIT_FAILURE && vm.status == EXIT_SUCCESS)
+		return (write_error(opts.trace));
+
+	return (vm.status);
+}
+
+/**
+ * trace_record - Encodes the record of one executed instruction.
+ * @t: The trace.
+ * @in: The instruction.
+ * @before: The top of stack before it ran, or TRACE_NONE.
+ * @after: The stack_t once it ran.
+ */
+void trace_record(trace_t *t, instr_t *in, long before, stack_t *after)
+{
+	unsigned char *p, *flags;
+
+	if (t->pos + TRACE_REC_MAX > TRACE_BLOCK)
+		trace_flush(t);
+	p = t->ring + (t->head % TRACE_RING) * TRACE_BLOCK + t->pos;
+	flags = p++;
+	*flags = in->op;
+	p = trace_put(p, (long)in->line - t->line);
+	t->line = in->line;
+	if (before == TRACE_NONE)
+		*flags |= TRACE_BEFORE_EMPTY;
+	else
+	{
+		p = trace_put(p, before - t->tos);
+		t->tos = before;
+	}
+	if (after->len == 0)
+		*flags |= TRACE_AFTER_EMPTY;
+	else
+	{
+		p = trace_put(p, STACK_AT(after, 0) - t->tos);
+		t->tos = STACK_AT(after, 0);
+	}
+	t->pos = p - (t->ring + (t->head % TRACE_RING) * TRACE_BLOCK);
+	t->n++;
+}
+
+/**
+ * trace_flush - Hands the block being filled to the writer thread.
+ * @t: The trace.
+ *
+ * Waits only if every block of the ring is still waiting to be written,
+ * so no record is ever dropped.
+ */
+void trace_flush(trace_t *t)
+{
+	pthread_mutex_lock(&t->lock);
+	t->lens[t->head % TRACE_RING] = t->pos;
+	t->counts[t->head % TRACE_RING] = t->n;
+	t->head++;
+	pthread_cond_broadcast(&t->cond);
+	while (t->head - t->tail >= TRACE_RING)
+		pthread_cond_wait(&t->cond, &t->lock);
+	pthread_mutex_unlock(&t->lock);
+	t->pos = 0;
+	t->n = 0;
+	t->line = 0;
+	t->tos = 0;
+}
@@ -0,0 +1,106 @@
+#include "monty.h"
+#include <string.h>
+#include <fcntl.h>
+
+int trace_open(trace_t *t, char *path);
+void *trace_writer(void *arg);
+int trace_close(trace_t *t);
+
+/**
+ * trace_open - Creates a trace file and starts its writer thread.
+ * @t: The trace to set up.
+ * @path: The trace file.
+ *
+ * Return: EXIT_SUCCESS, or EXIT_FAILURE after printing an error.
+ */
+int trace_open(trace_t *t, char *path)
+{
+	memset(t, 0, sizeof(*t));
+	t->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (t->fd == -1)
+		return (f_open_error(path));
+	t->ring = malloc(TRACE_RING * TRACE_BLOCK);
+	if (t->ring == NULL)
+	{
+		close(t->fd);
+		return (malloc_error());
+	}
+	if (write_full(t->fd, TRACE_MAGIC, 8) == EXIT_FAILURE)
+	{
+		free(t->ring);
+		close(t->fd);
+		return (write_error(path));
+	}
+	pthread_mutex_init(&t->lock, NULL);
+	pthread_cond_init(&t->cond, NULL);
+	if (pthread_create(&t->thread, NULL, trace_writer, t) != 0)
+	{
+		pthread_mutex_destroy(&t->lock);
+		pthread_cond_destroy(&t->cond);
+		free(t->ring);
+		close(t->fd);
+		return (malloc_error());
+	}
+	return (EXIT_SUCCESS);
+}
+
+/**
+ * trace_writer - Writes handed-over blocks to the trace file.
+ * @arg: The trace.
+ *
+ * Return: NULL, once the VM is done and every block is written.
+ */
+void *trace_writer(void *arg)
+{
+	trace_t *t = arg;
+	unsigned int hdr[2];
+	unsigned char *block;
+	int ok = 1;
+
+	pthread_mutex_lock(&t->lock);
+	while (1)
+	{
+		while (t->tail == t->head && !t->done)
+			pthread_cond_wait(&t->cond, &t->lock);
+		if (t->tail == t->head)
+			break;
+		hdr[0] = t->lens[t->tail % TRACE_RING];
+		hdr[1] = t->counts[t->tail % TRACE_RING];
+		block = t->ring + (t->tail % TRACE_RING) * TRACE_BLOCK;
+		pthread_mutex_unlock(&t->lock);
+		if (ok &&
+		    (write_full(t->fd, hdr, sizeof(hdr)) == EXIT_FAILURE ||
+		     write_full(t->fd, block, hdr[0]) == EXIT_FAILURE))
+			ok = 0;
+		pthread_mutex_lock(&t->lock);
+		t->failed |= !ok;
+		t->tail++;
+		pthread_cond_broadcast(&t->cond);
+	}
+	pthread_mutex_unlock(&t->lock);
+	return (NULL);
+}
+
+/**
+ * trace_close - Writes out the last records and closes a trace.
+ * @t: The trace.
+ *
+ * Return: EXIT_SUCCESS, or EXIT_FAILURE if part of the trace was not
+ * written.
+ */
+int trace_close(trace_t *t)
+{
+	if (t->n > 0)
+		trace_flush(t);
+	pthread_mutex_lock(&t->lock);
+	t->done = 1;
+	pthread_cond_broadcast(&t->cond);
+	pthread_mutex_unlock(&t->lock);
+	pthread_join(t->thread, NULL);
+	pthread_mutex_destroy(&t->lock);
+	pthread_cond_destroy(&t->cond);
+	free(t->ring);
+	if (close(t->fd) == -1)
+		t->failed = 1;
+	return (t->failed ? EXIT_FAILURE : EXIT_SUCCESS);
+}
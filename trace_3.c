@@ -0,0 +1,125 @@
+#include "monty.h"
+#include <string.h>
+
+int trace_decode(FILE *trace_fd);
+unsigned char *trace_put(unsigned char *p, long v);
+int trace_get(FILE *f, long *v);
+int trace_print(FILE *f, unsigned long count);
+
+/**
+ * trace_decode - Prints a trace recorded with --trace as text.
+ * @trace_fd: The trace file.
+ *
+ * Description: Prints one line per executed instruction: its line
+ * number, opcode and the top of stack before and after it ran ("-" for
+ * an empty stack).
+ *
+ * Return: EXIT_SUCCESS, or EXIT_FAILURE if the file is not a valid trace.
+ */
+int trace_decode(FILE *trace_fd)
+{
+	char magic[8];
+	unsigned int hdr[2];
+
+	if (fread(magic, 1, 8, trace_fd) != 8 ||
+	    memcmp(magic, TRACE_MAGIC, 8) != 0)
+	{
+		fprintf(stderr, "Error: not a trace file\n");
+		return (EXIT_FAILURE);
+	}
+	while (fread(hdr, sizeof(hdr), 1, trace_fd) == 1)
+	{
+		if (trace_print(trace_fd, hdr[1]) == EXIT_FAILURE)
+		{
+			fprintf(stderr, "Error: truncated trace file\n");
+			return (EXIT_FAILURE);
+		}
+	}
+	return (EXIT_SUCCESS);
+}
+
+/**
+ * trace_put - Appends a zigzag varint to an encoded record.
+ * @p: Where to write it.
+ * @v: The value.
+ *
+ * Return: The byte after the varint.
+ */
+unsigned char *trace_put(unsigned char *p, long v)
+{
+	unsigned long z = ((unsigned long)v << 1) ^ (v < 0 ? ~0UL : 0UL);
+
+	while (z >= 0x80)
+	{
+		*p++ = (unsigned char)(z | 0x80);
+		z >>= 7;
+	}
+	*p++ = (unsigned char)z;
+	return (p);
+}
+
+/**
+ * trace_get - Reads a zigzag varint.
+ * @f: The trace file.
+ * @v: Where to store the value.
+ *
+ * Return: EXIT_SUCCESS, or EXIT_FAILURE at the end of the file.
+ */
+int trace_get(FILE *f, long *v)
+{
+	unsigned long z = 0;
+	int c, shift = 0;
+
+	do {
+		c = getc(f);
+		if (c == EOF || shift > 63)
+			return (EXIT_FAILURE);
+		z |= (unsigned long)(c & 0x7f) << shift;
+		shift += 7;
+	} while (c & 0x80);
+	*v = (long)(z >> 1) ^ -(long)(z & 1);
+	return (EXIT_SUCCESS);
+}
+
+/**
+ * trace_print - Decodes and prints the records of one block.
+ * @f: The trace file, at the first record of the block.
+ * @count: Number of records in the block.
+ *
+ * Return: EXIT_SUCCESS, or EXIT_FAILURE if the block is cut short.
+ */
+int trace_print(FILE *f, unsigned long count)
+{
+	char text[32];
+	long line = 0, tos = 0, d;
+	int flags;
+
+	for (; count > 0; count--)
+	{
+		flags = getc(f);
+		if (flags == EOF || trace_get(f, &d) == EXIT_FAILURE ||
+		    (flags & 0x3f) >= OP_COUNT)
+			return (EXIT_FAILURE);
+		line += d;
+		printf("L%ld %-8s ", line, op_table[flags & 0x3f].opcode);
+		strcpy(text, "-");
+		if (!(flags & TRACE_BEFORE_EMPTY))
+		{
+			if (trace_get(f, &d) == EXIT_FAILURE)
+				return (EXIT_FAILURE);
+			tos += d;
+			sprintf(text, "%ld", tos);
+		}
+		printf("%s -> ", text);
+		strcpy(text, "-");
+		if (!(flags & TRACE_AFTER_EMPTY))
+		{
+			if (trace_get(f, &d) == EXIT_FAILURE)
+				return (EXIT_FAILURE);
+			tos += d;
+			sprintf(text, "%ld", tos);
+		}
+		printf("%s\n", text);
+	}
+	return (EXIT_SUCCESS);
+}
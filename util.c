@@ -0,0 +1,110 @@
+#include "monty.h"
+#include <errno.h>
+
+unsigned long hash_bytes(const char *buf, size_t len);
+int read_full(int fd, void *buf, size_t len);
+int write_full(int fd, const void *buf, size_t len);
+char *read_stream(FILE *stream, size_t *len);
+
+/**
+ * hash_bytes - Computes the 64-bit FNV-1a hash of a buffer.
+ * @buf: The bytes to hash.
+ * @len: Number of bytes.
+ *
+ * Return: The hash.
+ */
+unsigned long hash_bytes(const char *buf, size_t len)
+{
+	unsigned long hash = 14695981039346656037UL;
+	size_t i;
+
+	for (i = 0; i < len; i++)
+	{
+		hash ^= (unsigned char)buf[i];
+		hash *= 1099511628211UL;
+	}
+	return (hash);
+}
+
+/**
+ * read_full - Reads exactly len bytes from a file descriptor.
+ * @fd: The file descriptor.
+ * @buf: Where to store the bytes.
+ * @len: Number of bytes to read.
+ *
+ * Return: EXIT_SUCCESS, or EXIT_FAILURE on error or early end of file.
+ */
+int read_full(int fd, void *buf, size_t len)
+{
+	ssize_t n;
+
+	while (len > 0)
+	{
+		n = read(fd, buf, len);
+		if (n == -1 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			return (EXIT_FAILURE);
+		buf = (char *)buf + n;
+		len -= n;
+	}
+	return (EXIT_SUCCESS);
+}
+
+/**
+ * write_full - Writes exactly len bytes to a file descriptor.
+ * @fd: The file descriptor.
+ * @buf: The bytes to write.
+ * @len: Number of bytes to write.
+ *
+ * Return: EXIT_SUCCESS, or EXIT_FAILURE on error.
+ */
+int write_full(int fd, const void *buf, size_t len)
+{
+	ssize_t n;
+
+	while (len > 0)
+	{
+		n = write(fd, buf, len);
+		if (n == -1 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			return (EXIT_FAILURE);
+		buf = (const char *)buf + n;
+		len -= n;
+	}
+	return (EXIT_SUCCESS);
+}
+
+/**
+ * read_stream - Reads a whole stream into memory.
+ * @stream: The stream.
+ * @len: Set to the number of bytes read.
+ *
+ * Return: A malloc'ed buffer with one spare NUL byte at the end, or NULL
+ * if malloc fails.
+ */
+char *read_stream(FILE *stream, size_t *len)
+{
+	char *buf = NULL, *tmp;
+	size_t cap = 0, n;
+
+	*len = 0;
+	do {
+		if (cap - *len < 4096)
+		{
+			cap = cap ? cap * 2 : 65536;
+			tmp = realloc(buf, cap + 1);
+			if (tmp == NULL)
+			{
+				free(buf);
+				return (NULL);
+			}
+			buf = tmp;
+		}
+		n = fread(buf + *len, 1, cap - *len, stream);
+		*len += n;
+	} while (n > 0);
+	buf[*len] = '\0';
+	return (buf);
+}